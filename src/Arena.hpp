@@ -4,128 +4,2278 @@
 #include <stdexcept>
 #include <cstdint>
 #include <mutex>
-class MemoryArena {
+#include <atomic>
+#include <type_traits>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <tuple>
+#include <thread>
+#include <memory>
+#include <exception>
+
+#if __has_include(<sys/mman.h>)
+#include <sys/mman.h>
+#include <unistd.h>
+#define ARENA_HAS_MMAP 1
+#if __has_include(<sys/syscall.h>)
+#include <sys/syscall.h>
+#endif
+#else
+#define ARENA_HAS_MMAP 0
+#endif
+
+// Allocation counters cost a few relaxed atomic adds per bump, so they are
+// compiled in only when this is defined to 1 before the first include.
+#ifndef ARENA_ENABLE_STATS
+#define ARENA_ENABLE_STATS 0
+#endif
+
+// Same for the allocation hooks; with this at 0 set_hooks() is a no-op and
+// the allocation paths carry no hook check at all.
+#ifndef ARENA_ENABLE_HOOKS
+#define ARENA_ENABLE_HOOKS 0
+#endif
+
+// Granularity of CacheLineIsolated and allocate_isolated(). A fixed value
+// rather than std::hardware_destructive_interference_size, which GCC warns can
+// change with -mtune and so differ between translation units.
+#ifndef ARENA_CACHE_LINE_SIZE
+#define ARENA_CACHE_LINE_SIZE 64
+#endif
+
+// Return address of the public entry point it is used in. Once inlined that
+// function would report its caller's caller instead, so with hooks enabled
+// the entry points that report a call site are ARENA_HOOKED_ENTRY and stay
+// out of line; the address then lies in the direct caller at every
+// optimization level. Front-ends such as ArenaAllocator, TypedPool and
+// ArenaHeap take the address in their own entry points and pass it through
+// bump_notify() or notify_allocation(), so they report the frame that called
+// them. A caller that tail-calls the entry point reports its own call site.
+#if defined(__GNUC__) || defined(__clang__)
+#define ARENA_CALL_SITE() __builtin_return_address(0)
+#if ARENA_ENABLE_HOOKS
+#define ARENA_HOOKED_ENTRY __attribute__((noinline))
+#endif
+#else
+#define ARENA_CALL_SITE() static_cast<void*>(nullptr)
+#endif
+#ifndef ARENA_HOOKED_ENTRY
+#define ARENA_HOOKED_ENTRY
+#endif
+
+class ThreadLocalArena;
+class ArenaResource;
+template<typename T>
+class ArenaAllocator;
+template<typename T>
+class TypedPool;
+class ArenaHeap;
+template<typename... Fields>
+class ArenaSoA;
+template<typename K, typename V, typename Hash, typename KeyEqual>
+class ArenaFlatMap;
+class ArenaStringInterner;
+class ArenaSnapshot;
+class SharedArena;
+class ArenaFramePromise;
+
+enum class ArenaFlags : unsigned {
+    None     = 0,
+    LockFree = 1u << 0,  // bump current_ptr with a CAS loop instead of arena_mutex
+    EpochProtected = 1u << 1,  // reset() and rewind() wait for every enter() guard to leave
+    CacheLineIsolated = 1u << 2,  // every allocation starts on and fills whole cache lines
+};
+
+constexpr size_t arena_cache_line_size = ARENA_CACHE_LINE_SIZE;
+static_assert((arena_cache_line_size & (arena_cache_line_size - 1)) == 0, "ARENA_CACHE_LINE_SIZE must be a power of two");
+
+inline constexpr ArenaFlags operator|(ArenaFlags a, ArenaFlags b) {
+    return static_cast<ArenaFlags>(static_cast<unsigned>(a) | static_cast<unsigned>(b));
+}
+
+inline constexpr bool has_flag(ArenaFlags flags, ArenaFlags flag) {
+    return (static_cast<unsigned>(flags) & static_cast<unsigned>(flag)) != 0;
+}
+
+enum class GrowthPolicy {
+    Fixed,      // single block, allocation fails once it is used up
+    Linear,     // chain blocks of ArenaOptions::block_size
+    Geometric,  // each chained block is growth_factor times the previous one
+};
+
+enum class RetainPolicy {
+    KeepLargest,  // reset() frees every block except the largest
+    KeepAll,      // reset() keeps every block around for reuse
+};
+
+enum class BackingPolicy {
+    Heap,  // new char[size]
+    Mmap,  // reserve an anonymous mapping and commit it as the cursor advances
+};
+
+enum class HugePages {
+    None,
+    Transparent,  // madvise(MADV_HUGEPAGE) on a 2 MiB aligned range
+    Explicit,     // MAP_HUGETLB, falls back to Transparent if the pool is empty
+};
+
+enum class PurgeAdvice {
+    DontNeed,  // MADV_DONTNEED, pages read back as zero
+    Free,      // MADV_FREE where available, kernel reclaims lazily
+};
+
+struct ArenaOptions {
+    ArenaFlags flags = ArenaFlags::None;
+    GrowthPolicy growth = GrowthPolicy::Fixed;
+    RetainPolicy retain = RetainPolicy::KeepLargest;
+    size_t block_size = 0;      // Linear block size, 0 means the initial size
+    size_t growth_factor = 2;   // Geometric multiplier
+    size_t max_capacity = 0;    // hard cap on bytes across all blocks, 0 means no cap
+    size_t hot_region_size = 0; // separate block for allocate_hot(), 0 means none
+    size_t large_threshold = SIZE_MAX;  // requests of at least this many bytes get a mapping of their own
+
+    // Mmap backing only
+    BackingPolicy backing = BackingPolicy::Heap;
+    HugePages huge_pages = HugePages::None;
+    size_t commit_granularity = 1 << 20;  // bytes made accessible per commit step
+    size_t purge_above = SIZE_MAX;        // reset() returns pages past this offset to the OS
+    PurgeAdvice purge_advice = PurgeAdvice::DontNeed;
+    int numa_node = -1;                   // bind mapped blocks to this node, -1 leaves placement to the OS
+};
+
+struct ArenaUsage {
+    size_t block_remaining;  // bytes left in the block currently bumped
+    size_t block_capacity;   // size of that block
+    size_t total_remaining;  // block_remaining plus retained spare blocks
+    size_t total_capacity;   // bytes held across all blocks
+    size_t block_count;
+    size_t large_bytes;      // mapped for allocations at or above large_threshold
+};
+
+// Allocation sizes are bucketed by powers of four: [0, 16), [16, 64), ...,
+// with the last bucket catching everything from 1 MiB up.
+constexpr size_t arena_stats_bucket_count = 10;
+
+inline constexpr size_t arena_stats_bucket(size_t size) {
+    size_t bucket = 0;
+    for (size_t limit = 16; size >= limit && bucket + 1 < arena_stats_bucket_count; limit <<= 2) {
+        ++bucket;
+    }
+    return bucket;
+}
+
+// Snapshot returned by BasicArena::stats(). Every field is read with its own
+// relaxed load, so under concurrent allocation the fields may disagree by the
+// allocations that were in flight.
+struct ArenaStats {
+    uint64_t bytes_allocated = 0;     // requested bytes handed out, resizes included
+    uint64_t padding_bytes = 0;       // bytes skipped to reach an alignment boundary
+    uint64_t allocations = 0;
+    uint64_t failed_allocations = 0;  // bumps that returned nullptr
+    uint64_t in_use = 0;              // bytes handed out and not released, padding included
+    uint64_t peak_usage = 0;          // high-water mark of in_use since the last reset()
+    uint64_t reset_count = 0;
+    uint64_t size_buckets[arena_stats_bucket_count] = {};
+};
+
+template<bool Enabled>
+class ArenaStatsCounters {
+public:
+    static constexpr bool enabled = false;
+
+    void record_allocation(size_t, size_t) {}
+    void record_failure() {}
+    void record_resize(size_t, size_t) {}
+    void record_release(size_t) {}
+    void record_reset() {}
+    void restore_in_use(uint64_t) {}
+    uint64_t in_use() const { return 0; }
+    ArenaStats snapshot() const { return ArenaStats{}; }
+};
+
+template<>
+class ArenaStatsCounters<true> {
+    std::atomic<uint64_t> bytes_allocated{0};
+    std::atomic<uint64_t> padding_bytes{0};
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> failed_allocations{0};
+    std::atomic<uint64_t> in_use_bytes{0};
+    std::atomic<uint64_t> peak_usage{0};
+    std::atomic<uint64_t> reset_count{0};
+    std::atomic<uint64_t> size_buckets[arena_stats_bucket_count] = {};
+
+    void raise_peak(uint64_t used) {
+        uint64_t peak = peak_usage.load(std::memory_order_relaxed);
+        while (used > peak && !peak_usage.compare_exchange_weak(peak, used, std::memory_order_relaxed)) {
+        }
+    }
+public:
+    static constexpr bool enabled = true;
+
+    void record_allocation(size_t size, size_t padding) {
+        bytes_allocated.fetch_add(size, std::memory_order_relaxed);
+        padding_bytes.fetch_add(padding, std::memory_order_relaxed);
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        size_buckets[arena_stats_bucket(size)].fetch_add(1, std::memory_order_relaxed);
+        raise_peak(in_use_bytes.fetch_add(size + padding, std::memory_order_relaxed) + size + padding);
+    }
+    void record_failure() {
+        failed_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    // An in-place resize moves the cursor without being a new allocation.
+    void record_resize(size_t old_size, size_t new_size) {
+        if (new_size > old_size) {
+            bytes_allocated.fetch_add(new_size - old_size, std::memory_order_relaxed);
+            raise_peak(in_use_bytes.fetch_add(new_size - old_size, std::memory_order_relaxed) + new_size - old_size);
+        } else {
+            in_use_bytes.fetch_sub(old_size - new_size, std::memory_order_relaxed);
+        }
+    }
+    void record_release(size_t size) {
+        in_use_bytes.fetch_sub(size, std::memory_order_relaxed);
+    }
+    void record_reset() {
+        in_use_bytes.store(0, std::memory_order_relaxed);
+        peak_usage.store(0, std::memory_order_relaxed);
+        reset_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    void restore_in_use(uint64_t used) {
+        in_use_bytes.store(used, std::memory_order_relaxed);
+    }
+    uint64_t in_use() const {
+        return in_use_bytes.load(std::memory_order_relaxed);
+    }
+    ArenaStats snapshot() const {
+        ArenaStats result;
+        result.bytes_allocated = bytes_allocated.load(std::memory_order_relaxed);
+        result.padding_bytes = padding_bytes.load(std::memory_order_relaxed);
+        result.allocations = allocations.load(std::memory_order_relaxed);
+        result.failed_allocations = failed_allocations.load(std::memory_order_relaxed);
+        result.in_use = in_use_bytes.load(std::memory_order_relaxed);
+        result.peak_usage = peak_usage.load(std::memory_order_relaxed);
+        result.reset_count = reset_count.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < arena_stats_bucket_count; ++i) {
+            result.size_buckets[i] = size_buckets[i].load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+};
+
+// BasicArena StatsPolicy choices. The default follows ARENA_ENABLE_STATS.
+using NoStats = ArenaStatsCounters<false>;
+using CountingStats = ArenaStatsCounters<true>;
+
+// BasicArena LockPolicy choices. Any Lockable type works; NullLock compiles
+// the locking out for arenas that never leave one thread.
+using MutexLock = std::mutex;
+
+struct NullLock {
+    void lock() {}
+    void unlock() {}
+    bool try_lock() { return true; }
+};
+
+template<typename LockPolicy = MutexLock, typename StatsPolicy = ArenaStatsCounters<ARENA_ENABLE_STATS != 0>>
+class BasicArena;
+
+// Today's arena: mutex protected, with stats as configured by the macro.
+// Front-ends (ThreadLocalArena, ArenaAllocator, TypedPool, ArenaHeap) are
+// written against this configuration.
+using MemoryArena = BasicArena<>;
+
+// One size_t per type in allocate_many<Ts...>(counts...).
+template<typename T>
+using arena_count_t = size_t;
+
+enum class ArenaEvent {
+    Allocate,  // ptr and size of a successful allocate / allocate_array / allocate_bytes,
+               // or of an allocation served by a front-end over the arena
+    Failure,   // same calls when they return nullptr, ptr is nullptr
+    Reset,
+};
+
+// Installed with BasicArena::set_hooks(). on_event runs on the allocating
+// thread, outside arena_mutex, so it may allocate from other arenas but not
+// from the one it observes. arena identifies the arena that raised the event.
+// The caller keeps the struct alive while installed.
+struct ArenaHooks {
+    void (*on_event)(void* context, const void* arena, ArenaEvent event,
+                     const void* ptr, size_t size, size_t alignment, const void* call_site) = nullptr;
+    void* context = nullptr;
+};
+
+template<typename LockPolicy, typename StatsPolicy>
+class BasicArena {
 private:
-    char* const base_ptr;    
-    char* current_ptr;       
-    const size_t total_size; 
-    mutable std::mutex arena_mutex;
+    // Blocks form a singly linked chain: used blocks, then current_block, then
+    // empty spares retained by reset(). Each block keeps its own cursor so a
+    // lock-free bump never mixes one block's cursor with another's bounds.
+    struct Block {
+        char* base;
+        size_t size;
+        std::atomic<char*> cursor;
+        Block* next;
+        std::atomic<char*> committed;  // end of the accessible prefix, end() for heap blocks
+        void* mapping;                 // nullptr for heap blocks
+        size_t mapping_size;
+        bool borrowed = false;         // lives in a caller-provided buffer, see the buffer constructor
+        bool grouped = false;          // large block shared by one allocate_many() call
+        uint64_t sequence = 0;         // large blocks: creation order, see rewind()
+
+        char* end() const { return base + size; }
+    };
+
+    // Allocated in the arena right in front of every non-trivially
+    // destructible object or array, so trivial types carry no bookkeeping.
+    // Nodes form an intrusive stack that reset() and rewind() unwind.
+    struct Finalizer {
+        Finalizer* next;
+        void (*destroy)(void* object, size_t count);  // nullptr once deallocated
+        void* object;
+        size_t count;
+        uint64_t sequence;
+    };
+
+    Block* head;
+    std::atomic<Block*> current_block;
+    const ArenaOptions options;
+    size_t total_capacity;
+    size_t last_block_size;
+    const bool lock_free;
+    const bool epoch_protected;
+    const bool cache_isolated;
+    Block* hot;                        // allocate_hot() region, never chained
+    Block* large_blocks;               // one per allocation at or above large_threshold
+    size_t large_total;
+    uint64_t large_sequence;           // last Block::sequence handed out
+    std::atomic<size_t> epoch_participants{0};
+    std::atomic<bool> epoch_closed{false};  // set while reset() or rewind() drains participants
+    // Bumped by reset() and rewind(). Front-ends that hold arena memory across
+    // calls (pools, caches, containers) save it alongside that memory and
+    // compare it before each use; on a mismatch the memory is already
+    // reclaimed, so they forget it without running destructors and start over
+    // empty. None of them is notified, so objects left in one are abandoned.
+    std::atomic<uint64_t> generation;
+    uint64_t reset_count;              // markers taken before the last reset() are stale
+    std::atomic<Finalizer*> finalizers;
+    std::atomic<uint64_t> finalizer_sequence;
+    StatsPolicy counters;
+#if ARENA_ENABLE_HOOKS
+    std::atomic<const ArenaHooks*> hooks{nullptr};
+#endif
+    mutable LockPolicy arena_mutex;
+    LockPolicy reset_mutex;            // serializes reset() and rewind() across their destructor runs
+
+    friend class ThreadLocalArena;
+    friend class ArenaResource;
+    template<typename T>
+    friend class ArenaAllocator;
+    template<typename T>
+    friend class TypedPool;
+    friend class ArenaHeap;
+    template<typename... Fields>
+    friend class ArenaSoA;
+    template<typename K, typename V, typename Hash, typename KeyEqual>
+    friend class ArenaFlatMap;
+    friend class ArenaStringInterner;
+    friend class ArenaSnapshot;
+    friend class SharedArena;
+    friend class ArenaFramePromise;
+
+    // Takes ownership of a block built elsewhere, see ArenaSnapshot::load().
+    BasicArena(Block* first, const ArenaOptions& options);
+
+    Block* new_block(size_t size) const;
+    Block* new_mapped_block(size_t size) const;
+    static void free_block(Block* block);
+    static char* allocate_storage(size_t size);
+    static void free_storage(char* base);
+    static size_t page_size();
+    static char* try_bump(Block* block, size_t size, size_t alignment, bool atomic, size_t& padding);
+    bool commit(Block* block, char* end);
+    void purge(Block* block);
+    void bind_to_node(void* base, size_t size) const;
+
+    std::unique_lock<LockPolicy> acquire() const;
+    bool grow(Block* observed, size_t size, size_t alignment);
+    char* bump(size_t size, size_t alignment);
+    char* bump_hot(size_t size, size_t alignment);
+    Block* new_large_block(size_t size) const;
+    char* bump_large(size_t size, size_t alignment);
+    Block* find_large(const void* ptr) const;
+    bool is_large(const void* ptr);
+    bool resize_large(void* ptr, size_t old_size, size_t new_size);
+    bool free_large(void* ptr, const void* linked_node);
+    void free_large_blocks();
+    void free_large_after(uint64_t sequence);
+    template<typename T>
+    bool deallocate_large(T* objects, size_t count, bool destroyed = false);
+    template<typename T>
+    void release_array(T* array, size_t count);
+    template<typename T>
+    static constexpr size_t parallel_chunk();
+    template<typename Scheduler, typename Body>
+    static void for_each_chunk(size_t count, size_t chunk, Scheduler& scheduler, const Body& body);
+    bool create_hot_region();
+    static bool round_to_lines(size_t& size);
+    static bool isolate(size_t& size, size_t& alignment);
+    bool release(size_t size);
+    bool release_top(void* ptr, size_t size);
+    bool ends_at_cursor(const char* start, size_t size) const;
+    size_t used_in_current() const;
+
+    template<typename T>
+    T* reserve_array(size_t count);
+    template<typename T>
+    static constexpr size_t finalizer_offset();
+    template<typename T>
+    static void destroy_objects(void* object, size_t count);
+    template<typename T>
+    T* allocate_in_lines(bool in_hot_region, const void* call_site);
+    template<typename T>
+    T* reserve_uninit(size_t count, const void* call_site);
+    void register_finalizer(char* node, void* object, size_t count, void (*destroy)(void*, size_t));
+    bool forget_finalizer(void* object, size_t offset);
+    void run_finalizers(uint64_t down_to);
+
+    template<typename T>
+    static constexpr size_t slot_alignment();
+    template<typename T>
+    static bool add_slot(size_t count, size_t& total, size_t& offset);
+    template<typename T>
+    T* construct_slot(char* base, size_t offset, size_t count);
+    template<typename... Ts, size_t... I>
+    std::tuple<Ts*...> construct_many(char* base, const size_t* offsets, const size_t* counts,
+                                      std::index_sequence<I...>);
+
+    void notify(ArenaEvent event, const void* ptr, size_t size, size_t alignment, const void* call_site) const;
+    // For friend front-ends: bump_notify() when a request maps to one bump,
+    // notify_allocation() when the front-end serves it from its own chunks.
+    char* bump_notify(size_t size, size_t alignment, const void* call_site);
+    void notify_allocation(const void* ptr, size_t size, size_t alignment, const void* call_site) const;
+
+    // Held by reset() and rewind() in EpochProtected mode.
+    class EpochExclusive {
+        BasicArena* arena;
+    public:
+        explicit EpochExclusive(BasicArena* arena);
+        ~EpochExclusive();
+        EpochExclusive(const EpochExclusive&) = delete;
+        EpochExclusive& operator=(const EpochExclusive&) = delete;
+    };
 public:
-    explicit MemoryArena(size_t size);
-    ~MemoryArena();
-    
-    
-    MemoryArena(const MemoryArena&) = delete;
-    MemoryArena& operator=(const MemoryArena&) = delete;
+    // Saved bump position, see mark() / rewind().
+    struct Marker {
+        Block* block;
+        char* cursor;
+        uint64_t reset_count;
+        uint64_t finalizer_sequence;
+        uint64_t large_sequence;
+        uint64_t in_use;  // stats only, restored by rewind()
+    };
+
+    // Marks the calling thread as using arena memory until the guard is
+    // destroyed. Empty unless the arena is EpochProtected.
+    class EpochGuard {
+        BasicArena* arena = nullptr;
+
+        friend class BasicArena;
+        explicit EpochGuard(BasicArena* arena) : arena(arena) {}
+    public:
+        EpochGuard() = default;
+        EpochGuard(EpochGuard&& other) noexcept : arena(other.arena) { other.arena = nullptr; }
+        EpochGuard& operator=(EpochGuard&& other) noexcept;
+        ~EpochGuard() { leave(); }
+        void leave();
+    };
+
+    static constexpr bool stats_enabled = StatsPolicy::enabled;
+    static constexpr bool hooks_enabled = ARENA_ENABLE_HOOKS != 0;
+
+    explicit BasicArena(size_t size, ArenaFlags flags = ArenaFlags::None);
+    BasicArena(size_t size, const ArenaOptions& options);
+    // Uses [buffer, buffer + size) as the first block; the arena never frees
+    // it and reset() returns to it. Chained blocks come from options.backing.
+    BasicArena(void* buffer, size_t size, const ArenaOptions& options);
+    ~BasicArena();
+
+
+    BasicArena(const BasicArena&) = delete;
+    BasicArena& operator=(const BasicArena&) = delete;
+
+    template<typename T>
+    ARENA_HOOKED_ENTRY T* allocate();
+    // Like allocate(), but the object gets cache lines of its own; see
+    // ArenaFlags::CacheLineIsolated. allocate_hot() takes them from the
+    // options.hot_region_size region, apart from read-mostly data, and falls
+    // back to the main blocks once that region is full.
+    template<typename T>
+    ARENA_HOOKED_ENTRY T* allocate_isolated();
+    template<typename T>
+    ARENA_HOOKED_ENTRY T* allocate_hot();
+    template<typename T>
+    void deallocate(T*);
+    template<typename T>
+    ARENA_HOOKED_ENTRY T* allocate_array(size_t count);
+    template<typename T>
+    void deallocate_array(T* array, size_t count);
+    // Same, but constructors or destructors run in chunks through scheduler,
+    // with arena_mutex released; see ArenaThreadScheduler for the contract.
+    template<typename T, typename Scheduler>
+    ARENA_HOOKED_ENTRY T* allocate_array(size_t count, Scheduler&& scheduler);
+    template<typename T, typename Scheduler>
+    void deallocate_array(T* array, size_t count, Scheduler&& scheduler);
+    template<typename T>
+    ARENA_HOOKED_ENTRY T* allocate_array_uninit(size_t count);
+    template<typename T>
+    ARENA_HOOKED_ENTRY T* allocate_array_zeroed(size_t count);
+    template<typename T>
+    T* reallocate_array(T* array, size_t old_count, size_t new_count);
+    template<typename... Ts>
+    ARENA_HOOKED_ENTRY std::tuple<Ts*...> allocate_many(arena_count_t<Ts>... counts);
+
+    ARENA_HOOKED_ENTRY void* allocate_bytes(size_t size, size_t alignment = alignof(std::max_align_t));
+    bool try_extend(void* ptr, size_t old_size, size_t new_size);
+    // Unmaps an allocation of at least options.large_threshold bytes now
+    // instead of at reset(). Not for objects with destructors, deallocate()
+    // and deallocate_array() handle those. False if ptr is not one.
+    bool release_large(void* ptr);
+
+    EpochGuard enter();
+    ARENA_HOOKED_ENTRY void reset();
+    Marker mark() const;
+    void rewind(const Marker& marker);
+    size_t remaining() const;
+    size_t remaining_in_block() const;
+    size_t hot_remaining() const;
+    ArenaUsage usage() const;
+    char* get_alignment(size_t alignment);
+    ArenaStats stats() const { return counters.snapshot(); }
+    void set_hooks(const ArenaHooks* installed);
+    bool is_lock_free() const { return lock_free; }
+    bool is_epoch_protected() const { return epoch_protected; }
+};
+
+template<typename LockPolicy, typename StatsPolicy>
+BasicArena<LockPolicy, StatsPolicy>::BasicArena(size_t size, ArenaFlags flags)
+    : BasicArena(size, ArenaOptions{flags})
+{
+}
+
+template<typename LockPolicy, typename StatsPolicy>
+BasicArena<LockPolicy, StatsPolicy>::BasicArena(size_t size, const ArenaOptions& options)
+    : head(nullptr),
+      current_block(nullptr),
+      options(options),
+      total_capacity(0),
+      last_block_size(0),
+      lock_free(has_flag(options.flags, ArenaFlags::LockFree)),
+      epoch_protected(has_flag(options.flags, ArenaFlags::EpochProtected)),
+      cache_isolated(has_flag(options.flags, ArenaFlags::CacheLineIsolated)),
+      hot(nullptr),
+      large_blocks(nullptr),
+      large_total(0),
+      large_sequence(0),
+      generation(0),
+      reset_count(0),
+      finalizers(nullptr),
+      finalizer_sequence(0)
+{
+    head = new_block(size);
+    if (!head) {
+        throw std::bad_alloc();
+    }
+    current_block.store(head, std::memory_order_relaxed);
+    total_capacity = head->size;
+    last_block_size = head->size;
+    if (!create_hot_region()) {
+        free_block(head);
+        throw std::bad_alloc();
+    }
+}
+
+template<typename LockPolicy, typename StatsPolicy>
+BasicArena<LockPolicy, StatsPolicy>::BasicArena(Block* first, const ArenaOptions& options)
+    : head(first),
+      current_block(first),
+      options(options),
+      total_capacity(first->size),
+      last_block_size(first->size),
+      lock_free(has_flag(options.flags, ArenaFlags::LockFree)),
+      epoch_protected(has_flag(options.flags, ArenaFlags::EpochProtected)),
+      cache_isolated(has_flag(options.flags, ArenaFlags::CacheLineIsolated)),
+      hot(nullptr),
+      large_blocks(nullptr),
+      large_total(0),
+      large_sequence(0),
+      generation(0),
+      reset_count(0),
+      finalizers(nullptr),
+      finalizer_sequence(0)
+{
+    if (!create_hot_region()) {
+        free_block(first);
+        throw std::bad_alloc();
+    }
+}
+
+// The block header goes at the front of the buffer so that no part of the
+// first block touches the heap.
+template<typename LockPolicy, typename StatsPolicy>
+BasicArena<LockPolicy, StatsPolicy>::BasicArena(void* buffer, size_t size, const ArenaOptions& options)
+    : head(nullptr),
+      current_block(nullptr),
+      options(options),
+      total_capacity(0),
+      last_block_size(0),
+      lock_free(has_flag(options.flags, ArenaFlags::LockFree)),
+      epoch_protected(has_flag(options.flags, ArenaFlags::EpochProtected)),
+      cache_isolated(has_flag(options.flags, ArenaFlags::CacheLineIsolated)),
+      hot(nullptr),
+      large_blocks(nullptr),
+      large_total(0),
+      large_sequence(0),
+      generation(0),
+      reset_count(0),
+      finalizers(nullptr),
+      finalizer_sequence(0)
+{
+    uintptr_t start = reinterpret_cast<uintptr_t>(buffer);
+    uintptr_t header = (start + alignof(Block) - 1) & ~(alignof(Block) - 1);
+    size_t overhead = header - start + sizeof(Block);
+    if (!buffer || size <= overhead) {
+        throw std::bad_alloc();
+    }
+    char* base = reinterpret_cast<char*>(header) + sizeof(Block);
+    size_t usable = size - overhead;
+    head = new (reinterpret_cast<void*>(header)) Block{base, usable, {base}, nullptr, {base + usable}, nullptr, 0, true};
+    current_block.store(head, std::memory_order_relaxed);
+    total_capacity = usable;
+    last_block_size = usable;
+    if (!create_hot_region()) {
+        throw std::bad_alloc();
+    }
+}
+
+template<typename LockPolicy, typename StatsPolicy>
+BasicArena<LockPolicy, StatsPolicy>::~BasicArena()
+{
+    run_finalizers(0);
+    while (head) {
+        Block* next = head->next;
+        free_block(head);
+        head = next;
+    }
+    if (hot) {
+        free_block(hot);
+    }
+    free_large_blocks();
+}
+
+template<typename LockPolicy, typename StatsPolicy>
+bool BasicArena<LockPolicy, StatsPolicy>::create_hot_region()
+{
+    if (!options.hot_region_size) {
+        return true;
+    }
+    hot = new_block(options.hot_region_size);
+    return hot != nullptr;
+}
+
+// Returns nullptr when the backing store is out of memory.
+template<typename LockPolicy, typename StatsPolicy>
+typename BasicArena<LockPolicy, StatsPolicy>::Block* BasicArena<LockPolicy, StatsPolicy>::new_block(size_t size) const
+{
+    if (options.backing == BackingPolicy::Mmap) {
+        return new_mapped_block(size);
+    }
+    char* base = allocate_storage(size);
+    if (!base) {
+        return nullptr;
+    }
+    Block* block = new Block{base, size, {base}, nullptr, {base + size}, nullptr, 0};
+    return block;
+}
+
+// Reserves the whole block as an inaccessible mapping; commit() opens it up
+// in commit_granularity steps as the cursor moves forward. Explicit huge pages
+// are committed up front since hugetlb reserves the pool at mmap time anyway.
+template<typename LockPolicy, typename StatsPolicy>
+typename BasicArena<LockPolicy, StatsPolicy>::Block* BasicArena<LockPolicy, StatsPolicy>::new_mapped_block(size_t size) const
+{
+#if ARENA_HAS_MMAP
+    const size_t page = page_size();
+    const size_t huge_page = size_t(2) << 20;
+    size_t rounded = (size + page - 1) & ~(page - 1);
+
+#ifdef MAP_HUGETLB
+    if (options.huge_pages == HugePages::Explicit) {
+        size_t huge_rounded = (size + huge_page - 1) & ~(huge_page - 1);
+        void* mapping = mmap(nullptr, huge_rounded, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (mapping != MAP_FAILED) {
+            char* base = static_cast<char*>(mapping);
+            bind_to_node(base, huge_rounded);
+            return new Block{base, huge_rounded, {base}, nullptr, {base + huge_rounded}, mapping, huge_rounded};
+        }
+    }
+#endif
+
+    // Transparent huge pages need 2 MiB aligned extents, so over-reserve and
+    // start at the first aligned address inside the mapping.
+    bool transparent = options.huge_pages != HugePages::None;
+    size_t mapping_size = transparent ? rounded + huge_page : rounded;
+    void* mapping = mmap(nullptr, mapping_size, PROT_NONE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mapping == MAP_FAILED) {
+        return nullptr;
+    }
+    char* base = static_cast<char*>(mapping);
+    if (transparent) {
+        uintptr_t addr = reinterpret_cast<uintptr_t>(base);
+        base = reinterpret_cast<char*>((addr + huge_page - 1) & ~(huge_page - 1));
+#ifdef MADV_HUGEPAGE
+        madvise(base, rounded, MADV_HUGEPAGE);
+#endif
+    }
+    bind_to_node(base, rounded);
+    return new Block{base, rounded, {base}, nullptr, {base}, mapping, mapping_size};
+#else
+    char* base = allocate_storage(size);
+    if (!base) {
+        return nullptr;
+    }
+    return new Block{base, size, {base}, nullptr, {base + size}, nullptr, 0};
+#endif
+}
+
+// Applies an MPOL_BIND policy before any page is touched, so every page is
+// faulted in on numa_node. Placement is best effort: kernels without NUMA
+// support reject the call and the mapping keeps the default policy.
+template<typename LockPolicy, typename StatsPolicy>
+void BasicArena<LockPolicy, StatsPolicy>::bind_to_node(void* base, size_t size) const
+{
+#if ARENA_HAS_MMAP && defined(SYS_mbind)
+    if (options.numa_node < 0) {
+        return;
+    }
+    constexpr int mpol_bind = 2;
+    constexpr size_t mask_bits = sizeof(unsigned long) * 8;
+    unsigned long nodemask[16] = {};
+    size_t node = static_cast<size_t>(options.numa_node);
+    if (node >= mask_bits * 16) {
+        return;
+    }
+    nodemask[node / mask_bits] = 1ul << (node % mask_bits);
+    syscall(SYS_mbind, base, size, mpol_bind, nodemask, mask_bits * 16, 0);
+#else
+    (void)base;
+    (void)size;
+#endif
+}
+
+template<typename LockPolicy, typename StatsPolicy>
+void BasicArena<LockPolicy, StatsPolicy>::free_block(Block* block)
+{
+    if (block->borrowed) {
+        block->~Block();
+        return;
+    }
+#if ARENA_HAS_MMAP
+    if (block->mapping) {
+        munmap(block->mapping, block->mapping_size);
+        delete block;
+        return;
+    }
+#endif
+    free_storage(block->base);
+    delete block;
+}
+
+// Heap blocks start on a cache line, so the first isolated or hot allocation
+// of a block pays no padding.
+template<typename LockPolicy, typename StatsPolicy>
+char* BasicArena<LockPolicy, StatsPolicy>::allocate_storage(size_t size)
+{
+    return static_cast<char*>(::operator new(size, std::align_val_t(arena_cache_line_size), std::nothrow));
+}
+
+template<typename LockPolicy, typename StatsPolicy>
+void BasicArena<LockPolicy, StatsPolicy>::free_storage(char* base)
+{
+    ::operator delete(base, std::align_val_t(arena_cache_line_size));
+}
+
+template<typename LockPolicy, typename StatsPolicy>
+size_t BasicArena<LockPolicy, StatsPolicy>::page_size()
+{
+#if ARENA_HAS_MMAP
+    static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return page;
+#else
+    return 4096;
+#endif
+}
+
+// Makes [base, end) of a mapped block accessible. Must be called with
+// arena_mutex held.
+template<typename LockPolicy, typename StatsPolicy>
+bool BasicArena<LockPolicy, StatsPolicy>::commit(Block* block, char* end)
+{
+#if ARENA_HAS_MMAP
+    char* committed = block->committed.load(std::memory_order_relaxed);
+    if (end <= committed) {
+        return true;
+    }
+    size_t granularity = options.commit_granularity < page_size() ? page_size() : options.commit_granularity;
+    size_t wanted = static_cast<size_t>(end - block->base);
+    size_t target = wanted > SIZE_MAX - granularity ? block->size : ((wanted + granularity - 1) / granularity) * granularity;
+    if (target > block->size) {
+        target = block->size;
+    }
+    char* new_committed = block->base + target;
+    if (mprotect(committed, new_committed - committed, PROT_READ | PROT_WRITE) != 0) {
+        return false;
+    }
+    block->committed.store(new_committed, std::memory_order_release);
+    return true;
+#else
+    (void)block;
+    (void)end;
+    return true;
+#endif
+}
+
+// Hands the pages of a mapped block past purge_above back to the OS. They stay
+// committed, so the next use simply faults fresh pages in.
+template<typename LockPolicy, typename StatsPolicy>
+void BasicArena<LockPolicy, StatsPolicy>::purge(Block* block)
+{
+#if ARENA_HAS_MMAP
+    if (!block->mapping || options.purge_above == SIZE_MAX) {
+        return;
+    }
+    const size_t page = page_size();
+    size_t keep = options.purge_above > block->size ? block->size : options.purge_above;
+    keep = (keep + page - 1) & ~(page - 1);
+    char* from = block->base + keep;
+    char* to = block->committed.load(std::memory_order_relaxed);
+    if (to <= from) {
+        return;
+    }
+    int advice = MADV_DONTNEED;
+#ifdef MADV_FREE
+    if (options.purge_advice == PurgeAdvice::Free) {
+        advice = MADV_FREE;
+    }
+#endif
+    madvise(from, to - from, advice);
+#else
+    (void)block;
+#endif
+}
+
+// In lock-free mode the returned lock is not engaged; callers use atomics only.
+template<typename LockPolicy, typename StatsPolicy>
+std::unique_lock<LockPolicy> BasicArena<LockPolicy, StatsPolicy>::acquire() const
+{
+    if (lock_free) {
+        return std::unique_lock<LockPolicy>(arena_mutex, std::defer_lock);
+    }
+    return std::unique_lock<LockPolicy>(arena_mutex);
+}
+
+// Entering is one increment of a shared counter; it only waits while a
+// reset() or rewind() is draining. Guards do not nest: a thread holding one
+// must not enter again, or call reset() or rewind() on the same arena.
+template<typename LockPolicy, typename StatsPolicy>
+typename BasicArena<LockPolicy, StatsPolicy>::EpochGuard BasicArena<LockPolicy, StatsPolicy>::enter()
+{
+    if (!epoch_protected) {
+        return EpochGuard();
+    }
+    for (;;) {
+        while (epoch_closed.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+        epoch_participants.fetch_add(1, std::memory_order_seq_cst);
+        if (!epoch_closed.load(std::memory_order_seq_cst)) {
+            return EpochGuard(this);
+        }
+        epoch_participants.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+template<typename LockPolicy, typename StatsPolicy>
+void BasicArena<LockPolicy, StatsPolicy>::EpochGuard::leave()
+{
+    if (arena) {
+        arena->epoch_participants.fetch_sub(1, std::memory_order_release);
+        arena = nullptr;
+    }
+}
+
+template<typename LockPolicy, typename StatsPolicy>
+typename BasicArena<LockPolicy, StatsPolicy>::EpochGuard&
+BasicArena<LockPolicy, StatsPolicy>::EpochGuard::operator=(EpochGuard&& other) noexcept
+{
+    if (this != &other) {
+        leave();
+        arena = other.arena;
+        other.arena = nullptr;
+    }
+    return *this;
+}
+
+// Closes the epoch, so new participants wait, then waits for the ones
+// already inside to leave. Also serializes concurrent resets and rewinds.
+template<typename LockPolicy, typename StatsPolicy>
+BasicArena<LockPolicy, StatsPolicy>::EpochExclusive::EpochExclusive(BasicArena* arena)
+    : arena(arena)
+{
+    if (!arena->epoch_protected) {
+        return;
+    }
+    bool open = false;
+    while (!arena->epoch_closed.compare_exchange_weak(open, true, std::memory_order_seq_cst)) {
+        open = false;
+        std::this_thread::yield();
+    }
+    while (arena->epoch_participants.load(std::memory_order_seq_cst) != 0) {
+        std::this_thread::yield();
+    }
+}
+
+template<typename LockPolicy, typename StatsPolicy>
+BasicArena<LockPolicy, StatsPolicy>::EpochExclusive::~EpochExclusive()
+{
+    if (arena->epoch_protected) {
+        arena->epoch_closed.store(false, std::memory_order_release);
+    }
+}
+
+// Rewinds to the largest block, or to the caller's buffer if the arena has
+// one, in which case the largest chained block is kept as its first spare.
+// Depending on the retain policy the other blocks are either freed or kept
+// behind it as empty spares.
+template<typename LockPolicy, typename StatsPolicy>
+void BasicArena<LockPolicy, StatsPolicy>::reset(){
+    notify(ArenaEvent::Reset, nullptr, 0, 0, ARENA_CALL_SITE());
+    std::lock_guard<LockPolicy> serial(reset_mutex);
+    EpochExclusive exclusive(this);
+    run_finalizers(0);
+    std::lock_guard<LockPolicy> lock(arena_mutex);
+    free_large_blocks();
+
+    Block* largest = head;
+    for (Block* block = head; block; block = block->next) {
+        if (block->size > largest->size) {
+            largest = block;
+        }
+    }
+    Block* kept_spare = nullptr;
+    if (head->borrowed) {
+        kept_spare = largest != head ? largest : nullptr;
+        largest = head;
+    }
+
+    Block* spares = nullptr;
+    Block* block = head;
+    while (block) {
+        Block* next = block->next;
+        if (block != largest && (block == kept_spare || options.retain == RetainPolicy::KeepAll)) {
+            block->cursor.store(block->base, std::memory_order_relaxed);
+            purge(block);
+            block->next = spares;
+            spares = block;
+        } else if (block != largest) {
+            total_capacity -= block->size;
+            free_block(block);
+        }
+        block = next;
+    }
+
+    largest->cursor.store(largest->base, std::memory_order_relaxed);
+    purge(largest);
+    largest->next = spares;
+    head = largest;
+    current_block.store(largest, std::memory_order_release);
+    if (hot) {
+        hot->cursor.store(hot->base, std::memory_order_relaxed);
+        purge(hot);
+    }
+    reset_count++;
+    counters.record_reset();
+    generation.fetch_add(1, std::memory_order_release);
+}
+
+template<typename LockPolicy, typename StatsPolicy>
+typename BasicArena<LockPolicy, StatsPolicy>::Marker BasicArena<LockPolicy, StatsPolicy>::mark() const
+{
+    std::lock_guard<LockPolicy> lock(arena_mutex);
+    Block* block = current_block.load(std::memory_order_acquire);
+    return Marker{block, block->cursor.load(std::memory_order_acquire), reset_count,
+                  finalizer_sequence.load(std::memory_order_acquire), large_sequence, counters.in_use()};
+}
+
+// Restores the bump position saved by mark(), padding included. Blocks chained
+// after the marker become empty spares again, and large mappings made since are
+// unmapped. Markers from before a reset()
+// are ignored since their block may no longer exist. Like reset(), this must
+// not race with allocations that are still using the rewound memory, unless
+// the arena is EpochProtected and those threads hold enter() guards.
+template<typename LockPolicy, typename StatsPolicy>
+void BasicArena<LockPolicy, StatsPolicy>::rewind(const Marker& marker)
+{
+    std::lock_guard<LockPolicy> serial(reset_mutex);
+    EpochExclusive exclusive(this);
+    {
+        std::lock_guard<LockPolicy> lock(arena_mutex);
+        if (marker.reset_count != reset_count) {
+            return;
+        }
+    }
+    run_finalizers(marker.finalizer_sequence);
+
+    std::lock_guard<LockPolicy> lock(arena_mutex);
+
+    Block* current = current_block.load(std::memory_order_relaxed);
+    if (marker.block != current) {
+        for (Block* block = marker.block->next; block; block = block->next) {
+            block->cursor.store(block->base, std::memory_order_relaxed);
+            if (block == current) {
+                break;
+            }
+        }
+    }
+    marker.block->cursor.store(marker.cursor, std::memory_order_relaxed);
+    current_block.store(marker.block, std::memory_order_release);
+    free_large_after(marker.large_sequence);
+    counters.restore_in_use(marker.in_use);
+    generation.fetch_add(1, std::memory_order_release);
+}
+
+template<typename LockPolicy, typename StatsPolicy>
+size_t BasicArena<LockPolicy, StatsPolicy>::remaining() const {
+    std::lock_guard<LockPolicy> lock(arena_mutex);
+    Block* block = current_block.load(std::memory_order_acquire);
+    size_t total = block->size - (block->cursor.load(std::memory_order_acquire) - block->base);
+    for (Block* spare = block->next; spare; spare = spare->next) {
+        total += spare->size;
+    }
+    return total;
+}
+
+template<typename LockPolicy, typename StatsPolicy>
+size_t BasicArena<LockPolicy, StatsPolicy>::remaining_in_block() const {
+    auto lock = acquire();
+    Block* block = current_block.load(std::memory_order_acquire);
+    return block->size - (block->cursor.load(std::memory_order_acquire) - block->base);
+}
+
+template<typename LockPolicy, typename StatsPolicy>
+size_t BasicArena<LockPolicy, StatsPolicy>::hot_remaining() const {
+    if (!hot) {
+        return 0;
+    }
+    auto lock = acquire();
+    return hot->size - (hot->cursor.load(std::memory_order_acquire) - hot->base);
+}
+
+template<typename LockPolicy, typename StatsPolicy>
+ArenaUsage BasicArena<LockPolicy, StatsPolicy>::usage() const {
+    std::lock_guard<LockPolicy> lock(arena_mutex);
+    Block* block = current_block.load(std::memory_order_acquire);
+    ArenaUsage result{};
+    result.block_capacity = block->size;
+    result.block_remaining = block->size - (block->cursor.load(std::memory_order_acquire) - block->base);
+    result.total_remaining = result.block_remaining;
+    for (Block* spare = block->next; spare; spare = spare->next) {
+        result.total_remaining += spare->size;
+    }
+    for (Block* b = head; b; b = b->next) {
+        result.block_count++;
+    }
+    result.total_capacity = total_capacity;
+    result.large_bytes = large_total;
+    return result;
+}
+
+template<typename LockPolicy, typename StatsPolicy>
+char* BasicArena<LockPolicy, StatsPolicy>::get_alignment(size_t alignment)
+{
+    Block* block = current_block.load(std::memory_order_acquire);
+    uintptr_t addr = reinterpret_cast<uintptr_t>(block->cursor.load(std::memory_order_relaxed));
+    uintptr_t aligned_addr = (addr + alignment - 1) & ~(alignment - 1);
+
+    char* aligned_ptr = reinterpret_cast<char*>(aligned_addr);
+    return aligned_ptr;
+}
+
+// Reserves size bytes at the next alignment boundary of one block and reports
+// the bytes skipped to reach it. Returns nullptr when the block cannot fit the
+// request; its cursor is left untouched.
+template<typename LockPolicy, typename StatsPolicy>
+char* BasicArena<LockPolicy, StatsPolicy>::try_bump(Block* block, size_t size, size_t alignment, bool atomic, size_t& padding)
+{
+    const uintptr_t end = reinterpret_cast<uintptr_t>(block->end());
+
+    // Relaxed is enough here: the cursor only hands out disjoint ranges and
+    // publishes no data of its own.
+    char* current = block->cursor.load(std::memory_order_relaxed);
+    uintptr_t aligned;
+    do {
+        uintptr_t addr = reinterpret_cast<uintptr_t>(current);
+        aligned = (addr + alignment - 1) & ~(alignment - 1);
+        if (aligned > end || size > end - aligned) {
+            return nullptr;
+        }
+        if (!atomic) {
+            block->cursor.store(reinterpret_cast<char*>(aligned + size), std::memory_order_relaxed);
+            break;
+        }
+    } while (!block->cursor.compare_exchange_weak(current, reinterpret_cast<char*>(aligned + size),
+                                                  std::memory_order_relaxed));
+    padding = aligned - reinterpret_cast<uintptr_t>(current);
+    return reinterpret_cast<char*>(aligned);
+}
+
+// Makes a block that can fit the request current. Must be called with
+// arena_mutex held. Returns true if the caller should retry its bump, which
+// also covers another thread having grown the chain first.
+template<typename LockPolicy, typename StatsPolicy>
+bool BasicArena<LockPolicy, StatsPolicy>::grow(Block* observed, size_t size, size_t alignment)
+{
+    if (current_block.load(std::memory_order_relaxed) != observed) {
+        return true;
+    }
+    if (options.growth == GrowthPolicy::Fixed) {
+        return false;
+    }
+
+    size_t needed = size + alignment - 1;
+    if (needed < size) {
+        return false;
+    }
+
+    // Reuse a retained spare before asking for more memory.
+    Block* prev = observed;
+    for (Block* spare = observed->next; spare; prev = spare, spare = spare->next) {
+        if (spare->size >= needed) {
+            if (spare != observed->next) {
+                prev->next = spare->next;
+                spare->next = observed->next;
+                observed->next = spare;
+            }
+            spare->cursor.store(spare->base, std::memory_order_relaxed);
+            current_block.store(spare, std::memory_order_release);
+            return true;
+        }
+    }
+
+    size_t block_size = options.block_size ? options.block_size : last_block_size;
+    if (options.growth == GrowthPolicy::Geometric) {
+        block_size = last_block_size > SIZE_MAX / options.growth_factor
+            ? SIZE_MAX : last_block_size * options.growth_factor;
+    }
+    if (block_size < needed) {
+        block_size = needed;
+    }
+    if (options.max_capacity) {
+        // Large mappings count against the cap too.
+        size_t held = total_capacity + large_total;
+        if (held >= options.max_capacity || needed > options.max_capacity - held) {
+            return false;
+        }
+        if (block_size > options.max_capacity - held) {
+            block_size = options.max_capacity - held;
+        }
+    }
+
+    Block* block = new_block(block_size);
+    if (!block) {
+        return false;
+    }
+    block->next = observed->next;
+    observed->next = block;
+    total_capacity += block->size;
+    last_block_size = block->size;
+    current_block.store(block, std::memory_order_release);
+    return true;
+}
+
+// Heap blocks are fully committed, so the commit check never fires for them.
+// A failed commit strands the reserved bytes until the next reset().
+template<typename LockPolicy, typename StatsPolicy>
+char* BasicArena<LockPolicy, StatsPolicy>::bump(size_t size, size_t alignment)
+{
+    if (size >= options.large_threshold) {
+        return bump_large(size, alignment);
+    }
+    if (cache_isolated && !isolate(size, alignment)) {
+        counters.record_failure();
+        return nullptr;
+    }
+    size_t padding = 0;
+    if (!lock_free) {
+        std::lock_guard<LockPolicy> lock(arena_mutex);
+        for (;;) {
+            Block* block = current_block.load(std::memory_order_relaxed);
+            char* ptr = try_bump(block, size, alignment, false, padding);
+            if (ptr) {
+                if (ptr + size > block->committed.load(std::memory_order_relaxed) && !commit(block, ptr + size)) {
+                    counters.record_failure();
+                    return nullptr;
+                }
+                counters.record_allocation(size, padding);
+                return ptr;
+            }
+            if (!grow(block, size, alignment)) {
+                counters.record_failure();
+                return nullptr;
+            }
+        }
+    }
+
+    for (;;) {
+        Block* block = current_block.load(std::memory_order_acquire);
+        char* ptr = try_bump(block, size, alignment, true, padding);
+        if (ptr) {
+            if (ptr + size > block->committed.load(std::memory_order_acquire)) {
+                std::lock_guard<LockPolicy> lock(arena_mutex);
+                if (!commit(block, ptr + size)) {
+                    counters.record_failure();
+                    return nullptr;
+                }
+            }
+            counters.record_allocation(size, padding);
+            return ptr;
+        }
+        std::lock_guard<LockPolicy> lock(arena_mutex);
+        if (!grow(block, size, alignment)) {
+            counters.record_failure();
+            return nullptr;
+        }
+    }
+}
+
+// Returns false if size cannot be rounded up to whole cache lines.
+template<typename LockPolicy, typename StatsPolicy>
+bool BasicArena<LockPolicy, StatsPolicy>::round_to_lines(size_t& size)
+{
+    if (size > SIZE_MAX - (arena_cache_line_size - 1)) {
+        return false;
+    }
+    size = (size + arena_cache_line_size - 1) & ~(arena_cache_line_size - 1);
+    return true;
+}
 
-    template<typename T>
-    T* allocate();
-    template<typename T>  
-    void deallocate(T*);
-    template<typename T>
-    T* allocate_array(size_t count);
-    template<typename T>  
-    void deallocate_array(T* array, size_t count);
-    
-    void reset();
-    size_t remaining() const;
-    char* get_alignment(size_t alignment);
-};
-inline MemoryArena::MemoryArena(size_t size) 
-    : base_ptr(new char[size]),    
-      current_ptr(base_ptr),       
-      total_size(size)            
+// Widens a request to whole cache lines starting on a line boundary, so no
+// other allocation shares a line with it.
+template<typename LockPolicy, typename StatsPolicy>
+bool BasicArena<LockPolicy, StatsPolicy>::isolate(size_t& size, size_t& alignment)
+{
+    if (!round_to_lines(size)) {
+        return false;
+    }
+    if (alignment < arena_cache_line_size) {
+        alignment = arena_cache_line_size;
+    }
+    return true;
+}
+
+// Bumps the hot region, or the main blocks once it cannot fit the request.
+template<typename LockPolicy, typename StatsPolicy>
+char* BasicArena<LockPolicy, StatsPolicy>::bump_hot(size_t size, size_t alignment)
 {
-    
-    if (!base_ptr) {
-        throw std::bad_alloc();  
+    if (hot) {
+        size_t padding = 0;
+        auto lock = acquire();
+        char* ptr = try_bump(hot, size, alignment, lock_free, padding);
+        if (ptr) {
+            if (ptr + size > hot->committed.load(std::memory_order_acquire)) {
+                if (!lock.owns_lock()) {
+                    lock.lock();
+                }
+                if (!commit(hot, ptr + size)) {
+                    counters.record_failure();
+                    return nullptr;
+                }
+            }
+            counters.record_allocation(size, padding);
+            return ptr;
+        }
     }
+    return bump(size, alignment);
 }
 
-inline MemoryArena::~MemoryArena() 
+// A fully committed private mapping, so the pages go straight back to the OS
+// when it is freed.
+template<typename LockPolicy, typename StatsPolicy>
+typename BasicArena<LockPolicy, StatsPolicy>::Block* BasicArena<LockPolicy, StatsPolicy>::new_large_block(size_t size) const
 {
-    delete[] base_ptr;  
+#if ARENA_HAS_MMAP
+    const size_t page = page_size();
+    if (size > SIZE_MAX - (page - 1)) {
+        return nullptr;
+    }
+    size_t rounded = (size + page - 1) & ~(page - 1);
+    void* mapping = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) {
+        return nullptr;
+    }
+    char* base = static_cast<char*>(mapping);
+    bind_to_node(base, rounded);
+    return new Block{base, rounded, {base}, nullptr, {base + rounded}, mapping, rounded};
+#else
+    char* base = allocate_storage(size);
+    if (!base) {
+        return nullptr;
+    }
+    return new Block{base, size, {base}, nullptr, {base + size}, nullptr, 0};
+#endif
 }
 
-inline void MemoryArena::reset(){
-    std::lock_guard<std::mutex> lock(arena_mutex);
-    current_ptr = base_ptr;
+// Oversized requests bypass the bump blocks so they neither strand the small
+// allocations after them nor force a huge block into the chain.
+template<typename LockPolicy, typename StatsPolicy>
+char* BasicArena<LockPolicy, StatsPolicy>::bump_large(size_t size, size_t alignment)
+{
+    std::lock_guard<LockPolicy> lock(arena_mutex);
+    size_t needed = size + alignment - 1;
+    if (needed < size || (options.max_capacity &&
+                          (total_capacity + large_total > options.max_capacity ||
+                           needed > options.max_capacity - total_capacity - large_total))) {
+        counters.record_failure();
+        return nullptr;
+    }
+    Block* block = new_large_block(needed);
+    if (!block) {
+        counters.record_failure();
+        return nullptr;
+    }
+    size_t padding = 0;
+    char* ptr = try_bump(block, size, alignment, false, padding);
+    block->sequence = ++large_sequence;
+    block->next = large_blocks;
+    large_blocks = block;
+    large_total += block->size;
+    counters.record_allocation(size, padding);
+    return ptr;
 }
 
-inline size_t MemoryArena::remaining() const {
-    std::lock_guard<std::mutex> lock(arena_mutex);
-    return total_size - (current_ptr - base_ptr);
+// Frees the side-list block holding ptr. While a Finalizer node in it is
+// still linked into the stack the mapping has to stay until reset(), so only
+// the pages past the node are handed back. Must be called with arena_mutex
+// held.
+template<typename LockPolicy, typename StatsPolicy>
+bool BasicArena<LockPolicy, StatsPolicy>::free_large(void* ptr, const void* linked_node)
+{
+    char* start = static_cast<char*>(ptr);
+    Block* prev = nullptr;
+    for (Block* block = large_blocks; block; prev = block, block = block->next) {
+        if (start < block->base || start >= block->end()) {
+            continue;
+        }
+        if (block->grouped) {
+            // The other arrays of the group still live here; reset() frees it.
+            return true;
+        }
+        counters.record_release(static_cast<size_t>(block->cursor.load(std::memory_order_relaxed) - start));
+        if (linked_node) {
+#if ARENA_HAS_MMAP
+            const size_t page = page_size();
+            uintptr_t node_end = reinterpret_cast<uintptr_t>(linked_node) + sizeof(Finalizer);
+            char* from = reinterpret_cast<char*>((node_end + page - 1) & ~(page - 1));
+            if (block->mapping && from < block->end()) {
+                madvise(from, block->end() - from, MADV_DONTNEED);
+            }
+#endif
+            return true;
+        }
+        if (prev) {
+            prev->next = block->next;
+        } else {
+            large_blocks = block->next;
+        }
+        large_total -= block->size;
+        free_block(block);
+        return true;
+    }
+    return false;
 }
 
-inline char* MemoryArena::get_alignment(size_t alignment)
+// The side-list block holding ptr, or nullptr. Must be called with
+// arena_mutex held.
+template<typename LockPolicy, typename StatsPolicy>
+typename BasicArena<LockPolicy, StatsPolicy>::Block* BasicArena<LockPolicy, StatsPolicy>::find_large(const void* ptr) const
 {
-    uintptr_t addr = reinterpret_cast<uintptr_t>(current_ptr);
-    uintptr_t aligned_addr = (addr + alignment - 1) & ~(alignment - 1);
+    const char* start = static_cast<const char*>(ptr);
+    for (Block* block = large_blocks; block; block = block->next) {
+        if (start >= block->base && start < block->end()) {
+            return block;
+        }
+    }
+    return nullptr;
+}
 
-    char* aligned_ptr = reinterpret_cast<char*>(aligned_addr);
-    return aligned_ptr;
-} 
+// Large allocations are told apart by address, not by size: a large array
+// shrunk in place by reallocate_array() stays in its own mapping.
+template<typename LockPolicy, typename StatsPolicy>
+bool BasicArena<LockPolicy, StatsPolicy>::is_large(const void* ptr)
+{
+    if (options.large_threshold == SIZE_MAX) {
+        return false;
+    }
+    std::lock_guard<LockPolicy> lock(arena_mutex);
+    return find_large(ptr) != nullptr;
+}
+
+// try_extend() for an allocation in a side-list block: moves that block's
+// cursor when [ptr, ptr + new_size) still fits in the mapping.
+template<typename LockPolicy, typename StatsPolicy>
+bool BasicArena<LockPolicy, StatsPolicy>::resize_large(void* ptr, size_t old_size, size_t new_size)
+{
+    char* start = static_cast<char*>(ptr);
+    std::lock_guard<LockPolicy> lock(arena_mutex);
+    Block* block = find_large(ptr);
+    if (!block || block->cursor.load(std::memory_order_relaxed) != start + old_size ||
+        new_size > static_cast<size_t>(block->end() - start)) {
+        return false;
+    }
+    block->cursor.store(start + new_size, std::memory_order_relaxed);
+    counters.record_resize(old_size, new_size);
+    return true;
+}
+
+// Unmaps the large blocks created after the given sequence number. Must be
+// called with arena_mutex held.
+template<typename LockPolicy, typename StatsPolicy>
+void BasicArena<LockPolicy, StatsPolicy>::free_large_after(uint64_t sequence)
+{
+    Block** link = &large_blocks;
+    while (Block* block = *link) {
+        if (block->sequence > sequence) {
+            *link = block->next;
+            large_total -= block->size;
+            free_block(block);
+        } else {
+            link = &block->next;
+        }
+    }
+}
+
+template<typename LockPolicy, typename StatsPolicy>
+void BasicArena<LockPolicy, StatsPolicy>::free_large_blocks()
+{
+    while (large_blocks) {
+        Block* next = large_blocks->next;
+        free_block(large_blocks);
+        large_blocks = next;
+    }
+    large_total = 0;
+}
+
+template<typename LockPolicy, typename StatsPolicy>
+bool BasicArena<LockPolicy, StatsPolicy>::release_large(void* ptr)
+{
+    if (!ptr) return false;
+    std::lock_guard<LockPolicy> lock(arena_mutex);
+    return free_large(ptr, nullptr);
+}
+
+// Handles deallocate() and deallocate_array() for objects that bump() sent to
+// the side list. Unless destroyed is set the objects are destroyed first.
+template<typename LockPolicy, typename StatsPolicy>
+template<typename T>
+bool BasicArena<LockPolicy, StatsPolicy>::deallocate_large(T* objects, size_t count, bool destroyed)
+{
+    if (!is_large(objects)) {
+        return false;
+    }
+    if (!destroyed) {
+        destroy_objects<T>(objects, count);
+    }
+    const void* linked_node = nullptr;
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        if (!forget_finalizer(objects, finalizer_offset<T>())) {
+            linked_node = reinterpret_cast<char*>(objects) - finalizer_offset<T>();
+        }
+    }
+    std::lock_guard<LockPolicy> lock(arena_mutex);
+    free_large(objects, linked_node);
+    return true;
+}
+
+template<typename LockPolicy, typename StatsPolicy>
+size_t BasicArena<LockPolicy, StatsPolicy>::used_in_current() const
+{
+    Block* block = current_block.load(std::memory_order_acquire);
+    return block->cursor.load(std::memory_order_relaxed) - block->base;
+}
+
+// Whether the bump of size bytes at start is the newest one in the current
+// block. In cache-isolated mode that bump was widened to whole lines.
+template<typename LockPolicy, typename StatsPolicy>
+bool BasicArena<LockPolicy, StatsPolicy>::ends_at_cursor(const char* start, size_t size) const
+{
+    if (cache_isolated && !round_to_lines(size)) {
+        return false;
+    }
+    Block* block = current_block.load(std::memory_order_relaxed);
+    return start + size == block->cursor.load(std::memory_order_relaxed);
+}
+
+// Moves the current block's cursor back by size bytes if that stays inside it.
+template<typename LockPolicy, typename StatsPolicy>
+bool BasicArena<LockPolicy, StatsPolicy>::release(size_t size)
+{
+    if (cache_isolated && !round_to_lines(size)) {
+        return false;
+    }
+    Block* block = current_block.load(std::memory_order_acquire);
+    if (!lock_free) {
+        char* current = block->cursor.load(std::memory_order_relaxed);
+        if (static_cast<size_t>(current - block->base) < size) {
+            return false;
+        }
+        block->cursor.store(current - size, std::memory_order_relaxed);
+        counters.record_release(size);
+        return true;
+    }
+
+    char* current = block->cursor.load(std::memory_order_relaxed);
+    do {
+        if (static_cast<size_t>(current - block->base) < size) {
+            return false;
+        }
+    } while (!block->cursor.compare_exchange_weak(current, current - size, std::memory_order_relaxed));
+    counters.record_release(size);
+    return true;
+}
+
+// Offset of the object behind its Finalizer node. The bump is aligned for
+// both, so the object lands on its own alignment boundary.
+template<typename LockPolicy, typename StatsPolicy>
+template<typename T>
+constexpr size_t BasicArena<LockPolicy, StatsPolicy>::finalizer_offset()
+{
+    return (sizeof(Finalizer) + alignof(T) - 1) & ~(alignof(T) - 1);
+}
+
+template<typename LockPolicy, typename StatsPolicy>
+template<typename T>
+void BasicArena<LockPolicy, StatsPolicy>::destroy_objects(void* object, size_t count)
+{
+    T* array = static_cast<T*>(object);
+    for (size_t i = count; i > 0; --i) {
+        (array + i - 1)->~T();
+    }
+}
+
+template<typename LockPolicy, typename StatsPolicy>
+void BasicArena<LockPolicy, StatsPolicy>::register_finalizer(char* node, void* object, size_t count,
+                                            void (*destroy)(void*, size_t))
+{
+    Finalizer* finalizer = reinterpret_cast<Finalizer*>(node);
+    finalizer->destroy = destroy;
+    finalizer->object = object;
+    finalizer->count = count;
+    finalizer->sequence = finalizer_sequence.fetch_add(1, std::memory_order_relaxed) + 1;
+    finalizer->next = finalizers.load(std::memory_order_relaxed);
+    while (!finalizers.compare_exchange_weak(finalizer->next, finalizer,
+                                             std::memory_order_release, std::memory_order_relaxed)) {
+    }
+}
+
+// Disarms the node in front of an object that is being destroyed by hand.
+// Returns true if the node was also popped off the top of the stack.
+template<typename LockPolicy, typename StatsPolicy>
+bool BasicArena<LockPolicy, StatsPolicy>::forget_finalizer(void* object, size_t offset)
+{
+    Finalizer* finalizer = reinterpret_cast<Finalizer*>(static_cast<char*>(object) - offset);
+    finalizer->destroy = nullptr;
+    Finalizer* expected = finalizer;
+    return finalizers.compare_exchange_strong(expected, finalizer->next, std::memory_order_acq_rel);
+}
+
+// Destroys, newest first, every registered object with a sequence above
+// down_to. The nodes are first cut off the stack in one atomic step, so each
+// runs exactly once and a concurrent register_finalizer() is never lost. Runs
+// without arena_mutex so destructors may use the arena.
+template<typename LockPolicy, typename StatsPolicy>
+void BasicArena<LockPolicy, StatsPolicy>::run_finalizers(uint64_t down_to)
+{
+    Finalizer* detached;
+    Finalizer* rest = nullptr;
+    if (down_to == 0) {
+        detached = finalizers.exchange(nullptr, std::memory_order_acq_rel);
+    } else {
+        detached = finalizers.load(std::memory_order_acquire);
+        do {
+            rest = detached;
+            while (rest && rest->sequence > down_to) {
+                rest = rest->next;
+            }
+        } while (!finalizers.compare_exchange_weak(detached, rest, std::memory_order_acq_rel,
+                                                   std::memory_order_acquire));
+    }
+    for (Finalizer* finalizer = detached; finalizer != rest;) {
+        Finalizer* next = finalizer->next;
+        if (finalizer->destroy) {
+            finalizer->destroy(finalizer->object, finalizer->count);
+        }
+        finalizer = next;
+    }
+}
+
+// Runtime-sized raw allocation for records whose size and alignment are only
+// known at runtime. alignment must be a power of two. The memory is not
+// initialized and is never finalized.
+template<typename LockPolicy, typename StatsPolicy>
+void* BasicArena<LockPolicy, StatsPolicy>::allocate_bytes(size_t size, size_t alignment)
+{
+    if (size == 0) return nullptr;
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) return nullptr;
+    char* ptr = bump(size, alignment);
+    notify(ptr ? ArenaEvent::Allocate : ArenaEvent::Failure, ptr, size, alignment, ARENA_CALL_SITE());
+    return ptr;
+}
+
+template<typename LockPolicy, typename StatsPolicy>
+void BasicArena<LockPolicy, StatsPolicy>::set_hooks(const ArenaHooks* installed)
+{
+#if ARENA_ENABLE_HOOKS
+    hooks.store(installed, std::memory_order_release);
+#else
+    (void)installed;
+#endif
+}
+
+template<typename LockPolicy, typename StatsPolicy>
+void BasicArena<LockPolicy, StatsPolicy>::notify(ArenaEvent event, const void* ptr, size_t size, size_t alignment,
+                                const void* call_site) const
+{
+#if ARENA_ENABLE_HOOKS
+    const ArenaHooks* installed = hooks.load(std::memory_order_acquire);
+    if (installed && installed->on_event) {
+        installed->on_event(installed->context, this, event, ptr, size, alignment, call_site);
+    }
+#else
+    (void)event;
+    (void)ptr;
+    (void)size;
+    (void)alignment;
+    (void)call_site;
+#endif
+}
+
+template<typename LockPolicy, typename StatsPolicy>
+char* BasicArena<LockPolicy, StatsPolicy>::bump_notify(size_t size, size_t alignment, const void* call_site)
+{
+    char* ptr = bump(size, alignment);
+    notify_allocation(ptr, size, alignment, call_site);
+    return ptr;
+}
+
+template<typename LockPolicy, typename StatsPolicy>
+void BasicArena<LockPolicy, StatsPolicy>::notify_allocation(const void* ptr, size_t size, size_t alignment,
+                                                            const void* call_site) const
+{
+    notify(ptr ? ArenaEvent::Allocate : ArenaEvent::Failure, ptr, size, alignment, call_site);
+}
+
+// Grows or shrinks [ptr, ptr + old_size) in place when it is the most recent
+// allocation in the current block and the block has room. Returns false, with
+// nothing changed, otherwise.
+template<typename LockPolicy, typename StatsPolicy>
+bool BasicArena<LockPolicy, StatsPolicy>::try_extend(void* ptr, size_t old_size, size_t new_size)
+{
+    if (!ptr) return false;
+    char* start = static_cast<char*>(ptr);
+    if (cache_isolated && (!round_to_lines(old_size) || !round_to_lines(new_size))) {
+        return false;
+    }
+
+    auto lock = acquire();
+    Block* block = current_block.load(std::memory_order_acquire);
+    if (start < block->base || start > block->end() ||
+        old_size > static_cast<size_t>(block->end() - start) ||
+        new_size > static_cast<size_t>(block->end() - start)) {
+        return false;
+    }
 
+    char* expected = start + old_size;
+    if (!lock_free) {
+        if (block->cursor.load(std::memory_order_relaxed) != expected) {
+            return false;
+        }
+        if (start + new_size > block->committed.load(std::memory_order_relaxed) && !commit(block, start + new_size)) {
+            return false;
+        }
+        block->cursor.store(start + new_size, std::memory_order_relaxed);
+        counters.record_resize(old_size, new_size);
+        return true;
+    }
+
+    if (!block->cursor.compare_exchange_strong(expected, start + new_size, std::memory_order_relaxed)) {
+        return false;
+    }
+    if (start + new_size > block->committed.load(std::memory_order_acquire)) {
+        std::lock_guard<LockPolicy> commit_lock(arena_mutex);
+        if (!commit(block, start + new_size)) {
+            // Hand the extension back unless another thread has already
+            // bumped past it, in which case the bytes stay stranded.
+            char* extended = start + new_size;
+            block->cursor.compare_exchange_strong(extended, start + old_size, std::memory_order_relaxed);
+            return false;
+        }
+    }
+    counters.record_resize(old_size, new_size);
+    return true;
+}
+
+// Rolls the cursor back to ptr if [ptr, ptr + size) is the most recent
+// allocation in the current block. Alignment padding in front of ptr stays.
+template<typename LockPolicy, typename StatsPolicy>
+bool BasicArena<LockPolicy, StatsPolicy>::release_top(void* ptr, size_t size)
+{
+    if (options.large_threshold != SIZE_MAX) {
+        std::lock_guard<LockPolicy> lock(arena_mutex);
+        if (free_large(ptr, nullptr)) {
+            return true;
+        }
+    }
+    if (cache_isolated && !round_to_lines(size)) {
+        return false;
+    }
+    auto lock = acquire();
+    Block* block = current_block.load(std::memory_order_acquire);
+    char* expected = static_cast<char*>(ptr) + size;
+    if (!lock_free) {
+        if (block->cursor.load(std::memory_order_relaxed) != expected) {
+            return false;
+        }
+        block->cursor.store(static_cast<char*>(ptr), std::memory_order_relaxed);
+        counters.record_release(size);
+        return true;
+    }
+    if (!block->cursor.compare_exchange_strong(expected, static_cast<char*>(ptr), std::memory_order_relaxed)) {
+        return false;
+    }
+    counters.record_release(size);
+    return true;
+}
+
+template<typename LockPolicy, typename StatsPolicy>
 template<typename T>
-T* MemoryArena::allocate() 
+T* BasicArena<LockPolicy, StatsPolicy>::allocate()
 {
-    std::lock_guard<std::mutex> lock(arena_mutex);
     constexpr size_t alignment = alignof(T);
-    char* aligned_ptr = get_alignment(alignment);
-    if (aligned_ptr + sizeof(T) > base_ptr + total_size) {
+    if constexpr (std::is_trivially_destructible_v<T>) {
+        char* aligned_ptr = bump(sizeof(T), alignment);
+        if (!aligned_ptr) {
+            notify(ArenaEvent::Failure, nullptr, sizeof(T), alignment, ARENA_CALL_SITE());
+            return nullptr;
+        }
+        notify(ArenaEvent::Allocate, aligned_ptr, sizeof(T), alignment, ARENA_CALL_SITE());
+        T* new_object = new(aligned_ptr) T();
+        return new_object;
+    } else {
+        constexpr size_t offset = finalizer_offset<T>();
+        char* node = bump(offset + sizeof(T), alignment > alignof(Finalizer) ? alignment : alignof(Finalizer));
+        if (!node) {
+            notify(ArenaEvent::Failure, nullptr, sizeof(T), alignment, ARENA_CALL_SITE());
+            return nullptr;
+        }
+        notify(ArenaEvent::Allocate, node + offset, sizeof(T), alignment, ARENA_CALL_SITE());
+        T* new_object = new(node + offset) T();
+        register_finalizer(node, new_object, 1, &destroy_objects<T>);
+        return new_object;
+    }
+}
+
+// Shared by allocate_isolated() and allocate_hot(). A Finalizer node shares
+// the object's lines; it is only read again by reset() or rewind().
+template<typename LockPolicy, typename StatsPolicy>
+template<typename T>
+T* BasicArena<LockPolicy, StatsPolicy>::allocate_in_lines(bool in_hot_region, const void* call_site)
+{
+    constexpr size_t offset = std::is_trivially_destructible_v<T> ? 0 : finalizer_offset<T>();
+    size_t size = offset + sizeof(T);
+    size_t alignment = offset && alignof(Finalizer) > alignof(T) ? alignof(Finalizer) : alignof(T);
+    char* node = nullptr;
+    if (isolate(size, alignment)) {
+        node = in_hot_region ? bump_hot(size, alignment) : bump(size, alignment);
+    }
+    if (!node) {
+        notify(ArenaEvent::Failure, nullptr, sizeof(T), alignof(T), call_site);
         return nullptr;
     }
-    current_ptr = aligned_ptr + sizeof(T);
-    T* new_object = new(aligned_ptr) T();
+    notify(ArenaEvent::Allocate, node + offset, sizeof(T), alignof(T), call_site);
+    T* new_object = new(node + offset) T();
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        register_finalizer(node, new_object, 1, &destroy_objects<T>);
+    }
     return new_object;
 }
 
+template<typename LockPolicy, typename StatsPolicy>
+template<typename T>
+T* BasicArena<LockPolicy, StatsPolicy>::allocate_isolated()
+{
+    return allocate_in_lines<T>(false, ARENA_CALL_SITE());
+}
+
+template<typename LockPolicy, typename StatsPolicy>
 template<typename T>
-void MemoryArena::deallocate(T* object) 
+T* BasicArena<LockPolicy, StatsPolicy>::allocate_hot()
 {
-    std::lock_guard<std::mutex> lock(arena_mutex);
-    if (current_ptr - sizeof(T) >= base_ptr) {
+    return allocate_in_lines<T>(true, ARENA_CALL_SITE());
+}
+
+template<typename LockPolicy, typename StatsPolicy>
+template<typename T>
+void BasicArena<LockPolicy, StatsPolicy>::deallocate(T* object)
+{
+    if (deallocate_large(object, 1)) {
+        return;
+    }
+    auto lock = acquire();
+    if (used_in_current() >= sizeof(T)) {
         //deconstruct
         object->~T();
-        current_ptr -= sizeof(T);
-    }  
+        size_t size = sizeof(T);
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            char* node = reinterpret_cast<char*>(object) - finalizer_offset<T>();
+            bool on_top = ends_at_cursor(node, finalizer_offset<T>() + sizeof(T));
+            if (forget_finalizer(object, finalizer_offset<T>()) && on_top) {
+                size += finalizer_offset<T>();
+            }
+        }
+        release(size);
+    }
 }
 
+// Bumps storage for count objects, plus a Finalizer node in front of it for
+// non-trivially destructible types. Nothing is constructed or registered yet.
+template<typename LockPolicy, typename StatsPolicy>
 template<typename T>
-T* MemoryArena::allocate_array(size_t count) 
+T* BasicArena<LockPolicy, StatsPolicy>::reserve_array(size_t count)
 {
-    std::lock_guard<std::mutex> lock(arena_mutex);
-    
     if (count == 0) return nullptr;
     if (count > SIZE_MAX / sizeof(T)) return nullptr;
 
     size_t array_size = count * sizeof(T);
     constexpr size_t alignment = alignof(T);
-    char* aligned_ptr = get_alignment(alignment);
+    size_t offset = 0;
+    size_t bump_alignment = alignment;
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        offset = finalizer_offset<T>();
+        if (array_size > SIZE_MAX - offset) return nullptr;
+        bump_alignment = alignment > alignof(Finalizer) ? alignment : alignof(Finalizer);
+    }
+    char* aligned_ptr = bump(offset + array_size, bump_alignment);
+
+    if (!aligned_ptr) {
+        return nullptr;
+    }
+    return reinterpret_cast<T*>(aligned_ptr + offset);
+}
 
-    if (aligned_ptr + array_size > base_ptr + total_size) {  
+template<typename LockPolicy, typename StatsPolicy>
+template<typename T>
+T* BasicArena<LockPolicy, StatsPolicy>::allocate_array(size_t count)
+{
+    T* array_start = reserve_array<T>(count);
+    if (!array_start) {
+        if (count != 0) {
+            notify(ArenaEvent::Failure, nullptr, count * sizeof(T), alignof(T), ARENA_CALL_SITE());
+        }
         return nullptr;
     }
+    notify(ArenaEvent::Allocate, array_start, count * sizeof(T), alignof(T), ARENA_CALL_SITE());
 
-    T* array_start = reinterpret_cast<T*>(aligned_ptr);
     for (size_t i = 0; i < count; ++i) {
-        new(array_start + i) T();  
+        new(array_start + i) T();
     }
 
-    current_ptr = aligned_ptr + array_size;
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        register_finalizer(reinterpret_cast<char*>(array_start) - finalizer_offset<T>(),
+                           array_start, count, &destroy_objects<T>);
+    }
     return array_start;
 }
+
+// Resizes an array from allocate_array. When the array is the most recent
+// allocation the cursor just moves; otherwise the elements are moved into a
+// fresh array and the old one is destroyed and left for reset(), or unmapped
+// if it was a large allocation. Large arrays resize inside their own mapping
+// while it has room. New elements
+// are value-initialized like allocate_array. Returns nullptr, leaving the
+// original untouched, when the arena cannot fit the new size.
+template<typename LockPolicy, typename StatsPolicy>
+template<typename T>
+T* BasicArena<LockPolicy, StatsPolicy>::reallocate_array(T* array, size_t old_count, size_t new_count)
+{
+    if (!array || old_count == 0) {
+        return allocate_array<T>(new_count);
+    }
+    if (new_count == 0) {
+        deallocate_array<T>(array, old_count);
+        return nullptr;
+    }
+    if (new_count > SIZE_MAX / sizeof(T)) return nullptr;
+
+    const bool large = is_large(array);
+    const size_t old_size = old_count * sizeof(T);
+    const size_t new_size = new_count * sizeof(T);
+    if (new_count <= old_count ||
+        (large ? resize_large(array, old_size, new_size) : try_extend(array, old_size, new_size))) {
+        for (size_t i = new_count; i < old_count; ++i) {
+            (array + i)->~T();
+        }
+        if (new_count < old_count) {
+            if (large) {
+                resize_large(array, old_size, new_size);
+            } else {
+                try_extend(array, old_size, new_size);
+            }
+        }
+        for (size_t i = old_count; i < new_count; ++i) {
+            new(array + i) T();
+        }
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            Finalizer* finalizer = reinterpret_cast<Finalizer*>(reinterpret_cast<char*>(array) - finalizer_offset<T>());
+            finalizer->count = new_count;
+        }
+        return array;
+    }
+
+    T* fresh = reserve_array<T>(new_count);
+    if (!fresh) {
+        return nullptr;
+    }
+    if constexpr (std::is_trivially_copyable_v<T>) {
+        std::memcpy(static_cast<void*>(fresh), static_cast<const void*>(array), old_count * sizeof(T));
+    } else {
+        for (size_t i = 0; i < old_count; ++i) {
+            new(fresh + i) T(std::move(array[i]));
+        }
+    }
+    for (size_t i = old_count; i < new_count; ++i) {
+        new(fresh + i) T();
+    }
+
+    if (large) {
+        deallocate_large(array, old_count);
+    } else if constexpr (!std::is_trivially_destructible_v<T>) {
+        destroy_objects<T>(array, old_count);
+        forget_finalizer(array, finalizer_offset<T>());
+    }
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        register_finalizer(reinterpret_cast<char*>(fresh) - finalizer_offset<T>(),
+                           fresh, new_count, &destroy_objects<T>);
+    }
+    return fresh;
+}
+
+template<typename LockPolicy, typename StatsPolicy>
 template<typename T>
-void MemoryArena::deallocate_array(T* array, size_t count)
+void BasicArena<LockPolicy, StatsPolicy>::deallocate_array(T* array, size_t count)
 {
-    std::lock_guard<std::mutex> lock(arena_mutex);
     if (count == 0) return;
+    if (deallocate_large(array, count)) {
+        return;
+    }
+    auto lock = acquire();
+    destroy_objects<T>(array, count);
+    release_array(array, count);
+}
+
+// Disarms the finalizer of a destroyed array and pops it off the block when it
+// is on top. Must be called with the lock from acquire() held.
+template<typename LockPolicy, typename StatsPolicy>
+template<typename T>
+void BasicArena<LockPolicy, StatsPolicy>::release_array(T* array, size_t count)
+{
     size_t array_size = count * sizeof(T);
-       
-    for (size_t i = count; i > 0; --i) {
-        (array + i - 1)->~T();
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        char* node = reinterpret_cast<char*>(array) - finalizer_offset<T>();
+        bool on_top = ends_at_cursor(node, finalizer_offset<T>() + array_size);
+        if (forget_finalizer(array, finalizer_offset<T>()) && on_top) {
+            array_size += finalizer_offset<T>();
+        }
+    }
+    release(array_size);
+}
+
+// Elements per scheduled task: enough work to amortize the hand-off.
+template<typename LockPolicy, typename StatsPolicy>
+template<typename T>
+constexpr size_t BasicArena<LockPolicy, StatsPolicy>::parallel_chunk()
+{
+    constexpr size_t chunk_bytes = 64 * 1024;
+    return sizeof(T) >= chunk_bytes ? 1 : chunk_bytes / sizeof(T);
+}
+
+// Calls body(task, begin, end) for consecutive ranges of chunk elements. A
+// single range runs on the calling thread without involving the scheduler.
+template<typename LockPolicy, typename StatsPolicy>
+template<typename Scheduler, typename Body>
+void BasicArena<LockPolicy, StatsPolicy>::for_each_chunk(size_t count, size_t chunk, Scheduler& scheduler, const Body& body)
+{
+    size_t task_count = count / chunk + (count % chunk != 0);
+    if (task_count <= 1) {
+        body(0, 0, count);
+        return;
+    }
+    scheduler(task_count, [&](size_t task) {
+        size_t begin = task * chunk;
+        size_t end = count - begin < chunk ? count : begin + chunk;
+        body(task, begin, end);
+    });
+}
+
+// The range is reserved first and only then constructed, so the arena stays
+// available to other threads meanwhile. If a constructor throws, everything
+// already built is destroyed and the first exception is rethrown here; the
+// memory then stays reserved until reset().
+template<typename LockPolicy, typename StatsPolicy>
+template<typename T, typename Scheduler>
+T* BasicArena<LockPolicy, StatsPolicy>::allocate_array(size_t count, Scheduler&& scheduler)
+{
+    T* array_start = reserve_array<T>(count);
+    if (!array_start) {
+        if (count != 0) {
+            notify(ArenaEvent::Failure, nullptr, count * sizeof(T), alignof(T), ARENA_CALL_SITE());
+        }
+        return nullptr;
+    }
+    notify(ArenaEvent::Allocate, array_start, count * sizeof(T), alignof(T), ARENA_CALL_SITE());
+
+    constexpr size_t chunk = parallel_chunk<T>();
+    if constexpr (std::is_nothrow_default_constructible_v<T>) {
+        for_each_chunk(count, chunk, scheduler, [array_start](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                new(array_start + i) T();
+            }
+        });
+    } else {
+        std::unique_ptr<bool[]> built(new bool[count / chunk + 1]());
+        std::exception_ptr failure;
+        std::mutex failure_mutex;
+        for_each_chunk(count, chunk, scheduler, [&](size_t task, size_t begin, size_t end) {
+            size_t i = begin;
+            try {
+                for (; i < end; ++i) {
+                    new(array_start + i) T();
+                }
+                built[task] = true;
+            } catch (...) {
+                destroy_objects<T>(array_start + begin, i - begin);
+                std::lock_guard<std::mutex> lock(failure_mutex);
+                if (!failure) {
+                    failure = std::current_exception();
+                }
+            }
+        });
+        if (failure) {
+            for (size_t begin = 0, task = 0; begin < count; begin += chunk, ++task) {
+                if (built[task]) {
+                    destroy_objects<T>(array_start + begin, count - begin < chunk ? count - begin : chunk);
+                }
+            }
+            std::rethrow_exception(failure);
+        }
+    }
+
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        register_finalizer(reinterpret_cast<char*>(array_start) - finalizer_offset<T>(),
+                           array_start, count, &destroy_objects<T>);
     }
-    if (current_ptr - array_size >= base_ptr) {
-        current_ptr -= array_size;
+    return array_start;
+}
+
+// Destructors run without the lock; only the final pop takes it.
+template<typename LockPolicy, typename StatsPolicy>
+template<typename T, typename Scheduler>
+void BasicArena<LockPolicy, StatsPolicy>::deallocate_array(T* array, size_t count, Scheduler&& scheduler)
+{
+    if (count == 0) return;
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        for_each_chunk(count, parallel_chunk<T>(), scheduler, [array](size_t, size_t begin, size_t end) {
+            destroy_objects<T>(array + begin, end - begin);
+        });
+    }
+    if (deallocate_large(array, count, true)) {
+        return;
+    }
+    auto lock = acquire();
+    release_array(array, count);
+}
+
+// Reserves the array without touching its memory. Only for trivial types,
+// which need neither construction nor a finalizer.
+template<typename LockPolicy, typename StatsPolicy>
+template<typename T>
+T* BasicArena<LockPolicy, StatsPolicy>::reserve_uninit(size_t count, const void* call_site)
+{
+    static_assert(std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>,
+                  "allocate_array_uninit requires a trivially constructible and destructible type");
+    if (count == 0) return nullptr;
+    if (count > SIZE_MAX / sizeof(T)) return nullptr;
+
+    char* ptr = bump(count * sizeof(T), alignof(T));
+    notify(ptr ? ArenaEvent::Allocate : ArenaEvent::Failure, ptr, count * sizeof(T), alignof(T), call_site);
+    return reinterpret_cast<T*>(ptr);
+}
+
+template<typename LockPolicy, typename StatsPolicy>
+template<typename T>
+T* BasicArena<LockPolicy, StatsPolicy>::allocate_array_uninit(size_t count)
+{
+    return reserve_uninit<T>(count, ARENA_CALL_SITE());
+}
+
+// Like allocate_array_uninit, but clears the memory in one memset, which libc
+// vectorizes, instead of value-initializing element by element. The result is
+// all-bits-zero.
+template<typename LockPolicy, typename StatsPolicy>
+template<typename T>
+T* BasicArena<LockPolicy, StatsPolicy>::allocate_array_zeroed(size_t count)
+{
+    T* array_start = reserve_uninit<T>(count, ARENA_CALL_SITE());
+    if (array_start) {
+        std::memset(static_cast<void*>(array_start), 0, count * sizeof(T));
+    }
+    return array_start;
+}
+
+// Alignment of one allocate_many slot: the array, behind its Finalizer node
+// for non-trivially destructible types.
+template<typename LockPolicy, typename StatsPolicy>
+template<typename T>
+constexpr size_t BasicArena<LockPolicy, StatsPolicy>::slot_alignment()
+{
+    if constexpr (std::is_trivially_destructible_v<T>) {
+        return alignof(T);
+    } else {
+        return alignof(T) > alignof(Finalizer) ? alignof(T) : alignof(Finalizer);
+    }
+}
+
+// Appends a slot for count objects to the layout, returning false on overflow.
+// Empty slots take no space and are marked with offset SIZE_MAX.
+template<typename LockPolicy, typename StatsPolicy>
+template<typename T>
+bool BasicArena<LockPolicy, StatsPolicy>::add_slot(size_t count, size_t& total, size_t& offset)
+{
+    if (count == 0) {
+        offset = SIZE_MAX;
+        return true;
+    }
+    constexpr size_t alignment = slot_alignment<T>();
+    size_t header = 0;
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        header = finalizer_offset<T>();
+    }
+    if (count > (SIZE_MAX - header) / sizeof(T) || total > SIZE_MAX - alignment) {
+        return false;
+    }
+    size_t start = (total + alignment - 1) & ~(alignment - 1);
+    size_t size = header + count * sizeof(T);
+    if (size > SIZE_MAX - start) {
+        return false;
+    }
+    offset = start;
+    total = start + size;
+    return true;
+}
+
+template<typename LockPolicy, typename StatsPolicy>
+template<typename T>
+T* BasicArena<LockPolicy, StatsPolicy>::construct_slot(char* base, size_t offset, size_t count)
+{
+    if (offset == SIZE_MAX) {
+        return nullptr;
+    }
+    char* node = base + offset;
+    T* array_start;
+    if constexpr (std::is_trivially_destructible_v<T>) {
+        array_start = reinterpret_cast<T*>(node);
+    } else {
+        array_start = reinterpret_cast<T*>(node + finalizer_offset<T>());
+    }
+    for (size_t i = 0; i < count; ++i) {
+        new(array_start + i) T();
+    }
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        register_finalizer(node, array_start, count, &destroy_objects<T>);
+    }
+    return array_start;
+}
+
+template<typename LockPolicy, typename StatsPolicy>
+template<typename... Ts, size_t... I>
+std::tuple<Ts*...> BasicArena<LockPolicy, StatsPolicy>::construct_many(char* base, const size_t* offsets,
+                                                                      const size_t* counts,
+                                                                      std::index_sequence<I...>)
+{
+    // Braced initialization constructs the slots left to right.
+    return std::tuple<Ts*...>{construct_slot<Ts>(base, offsets[I], counts[I])...};
+}
+
+// Allocates counts[i] value-initialized objects of each Ts[i] with a single
+// bump, so one lock or CAS covers the whole group and the arrays sit next to
+// each other. A count of 0 yields nullptr for that type. On failure every
+// pointer is nullptr and nothing is constructed. Each array is its own
+// allocation for deallocate_array and finalizers, except that a group at or
+// above large_threshold shares one mapping, which stays until reset().
+template<typename LockPolicy, typename StatsPolicy>
+template<typename... Ts>
+std::tuple<Ts*...> BasicArena<LockPolicy, StatsPolicy>::allocate_many(arena_count_t<Ts>... counts)
+{
+    size_t alignment = 1;
+    ((alignment = slot_alignment<Ts>() > alignment ? slot_alignment<Ts>() : alignment), ...);
+    const size_t count_list[] = {counts..., 0};
+    size_t offsets[sizeof...(Ts) + 1] = {};
+    size_t total = 0;
+    size_t index = 0;
+    bool fits = (add_slot<Ts>(counts, total, offsets[index++]) && ...);
+    if (!fits) {
+        return std::tuple<Ts*...>{};
+    }
+    if (total == 0) {
+        return std::tuple<Ts*...>{};
+    }
+
+    char* base = bump(total, alignment);
+    notify(base ? ArenaEvent::Allocate : ArenaEvent::Failure, base, total, alignment, ARENA_CALL_SITE());
+    if (!base) {
+        return std::tuple<Ts*...>{};
+    }
+    if (total >= options.large_threshold) {
+        std::lock_guard<LockPolicy> lock(arena_mutex);
+        if (Block* block = find_large(base)) {
+            block->grouped = true;
+        }
     }
-}
\ No newline at end of file
+    return construct_many<Ts...>(base, offsets, count_list, std::index_sequence_for<Ts...>{});
+}
+
+// Rewinds the arena to where it was when the scope was entered, releasing all
+// scratch allocations made inside it in O(1).
+template<typename Arena = MemoryArena>
+class ArenaScope {
+private:
+    Arena& arena;
+    const typename Arena::Marker marker;
+public:
+    explicit ArenaScope(Arena& arena) : arena(arena), marker(arena.mark()) {}
+    ~ArenaScope() { arena.rewind(marker); }
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Arena.hpp"
+#include <memory_resource>
+
+// Standard Allocator over a MemoryArena, so containers can move to the arena
+// with only a type change. Memory uses the same aligned bump as
+// allocate_array; deallocate only gives memory back when it is the most
+// recent allocation, everything else waits for the arena's reset().
+template<typename T>
+class ArenaAllocator {
+private:
+    MemoryArena* arena_ptr;
+
+    template<typename U>
+    friend class ArenaAllocator;
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    ArenaAllocator(MemoryArena& arena) noexcept : arena_ptr(&arena) {}
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena_ptr(other.arena_ptr) {}
+
+    ARENA_HOOKED_ENTRY T* allocate(size_t count);
+    void deallocate(T* ptr, size_t count) noexcept;
+
+    MemoryArena& arena() const noexcept { return *arena_ptr; }
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept { return arena_ptr == other.arena_ptr; }
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept { return arena_ptr != other.arena_ptr; }
+};
+
+// Throws std::bad_alloc on exhaustion, as the Allocator requirements demand.
+template<typename T>
+T* ArenaAllocator<T>::allocate(size_t count)
+{
+    if (count > SIZE_MAX / sizeof(T)) {
+        throw std::bad_alloc();
+    }
+    char* ptr = arena_ptr->bump_notify(count * sizeof(T), alignof(T), ARENA_CALL_SITE());
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return reinterpret_cast<T*>(ptr);
+}
+
+template<typename T>
+void ArenaAllocator<T>::deallocate(T* ptr, size_t count) noexcept
+{
+    arena_ptr->release_top(ptr, count * sizeof(T));
+}
+
+// std::pmr::memory_resource over a MemoryArena with the same semantics as
+// ArenaAllocator: aligned bump allocation, LIFO-aware deallocation.
+class ArenaResource : public std::pmr::memory_resource {
+private:
+    MemoryArena& arena_ref;
+public:
+    explicit ArenaResource(MemoryArena& arena) noexcept : arena_ref(arena) {}
+
+    MemoryArena& arena() const noexcept { return arena_ref; }
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+};
+
+ARENA_HOOKED_ENTRY inline void* ArenaResource::do_allocate(size_t bytes, size_t alignment)
+{
+    char* ptr = arena_ref.bump_notify(bytes, alignment, ARENA_CALL_SITE());
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+inline void ArenaResource::do_deallocate(void* ptr, size_t bytes, size_t)
+{
+    arena_ref.release_top(ptr, bytes);
+}
+
+inline bool ArenaResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    const ArenaResource* resource = dynamic_cast<const ArenaResource*>(&other);
+    return resource && &resource->arena_ref == &arena_ref;
+}
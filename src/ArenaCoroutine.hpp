@@ -0,0 +1,253 @@
+#pragma once
+
+#include "Arena.hpp"
+#include <exception>
+
+#if defined(__has_include)
+#if __has_include(<coroutine>) && defined(__cpp_impl_coroutine)
+#include <coroutine>
+#define ARENA_HAS_COROUTINES 1
+#endif
+#endif
+#ifndef ARENA_HAS_COROUTINES
+#define ARENA_HAS_COROUTINES 0
+#endif
+
+// Makes a MemoryArena the frame source for coroutines started on this thread
+// while the scope is alive. Scopes nest; the innermost one wins.
+class ArenaFrameScope {
+private:
+    static inline thread_local MemoryArena* active = nullptr;
+    MemoryArena* previous;
+public:
+    explicit ArenaFrameScope(MemoryArena& arena) : previous(active) { active = &arena; }
+    ~ArenaFrameScope() { active = previous; }
+
+    ArenaFrameScope(const ArenaFrameScope&) = delete;
+    ArenaFrameScope& operator=(const ArenaFrameScope&) = delete;
+
+    static MemoryArena* current() { return active; }
+};
+
+// Mixin for a coroutine promise_type that draws frames from the MemoryArena
+// of the thread's innermost ArenaFrameScope instead of the heap. Without a
+// scope, or when the arena is exhausted, the frame comes from ::operator new.
+// A request-scoped arena is one ArenaFrameScope around the request handler.
+// The arena is not taken from a coroutine parameter: GCC flags every
+// parameter-matching operator new with -Wmismatched-new-delete.
+//
+// A small header in front of each frame remembers its arena and generation.
+// Freeing a frame that is the arena's most recent allocation, as happens when
+// awaited coroutines finish in stack order, pops it with release_top; a frame
+// at or above the arena's large_threshold is unmapped in any order. Any other
+// frame stays in the arena until its reset(). Frames must not outlive the
+// arena's reset().
+class ArenaFramePromise {
+private:
+    struct FrameHeader {
+        MemoryArena* arena;
+        uint64_t generation;
+    };
+
+    static constexpr size_t frame_alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+    static constexpr size_t header_size = (sizeof(FrameHeader) + frame_alignment - 1) & ~(frame_alignment - 1);
+
+    static void* allocate_frame(size_t size, MemoryArena* arena);
+public:
+    static void* operator new(size_t size) { return allocate_frame(size, ArenaFrameScope::current()); }
+    static void operator delete(void* frame, size_t size);
+};
+
+inline void* ArenaFramePromise::allocate_frame(size_t size, MemoryArena* arena)
+{
+    if (size > SIZE_MAX - header_size) {
+        throw std::bad_alloc();
+    }
+    size_t total = size + header_size;
+    void* block = nullptr;
+    uint64_t generation = 0;
+    if (arena) {
+        generation = arena->generation.load(std::memory_order_acquire);
+        block = arena->allocate_bytes(total, frame_alignment);
+    }
+    if (block) {
+        new (block) FrameHeader{arena, generation};
+    } else {
+        block = ::operator new(total);
+        new (block) FrameHeader{nullptr, 0};
+    }
+    return static_cast<char*>(block) + header_size;
+}
+
+inline void ArenaFramePromise::operator delete(void* frame, size_t size)
+{
+    char* block = static_cast<char*>(frame) - header_size;
+    FrameHeader* header = reinterpret_cast<FrameHeader*>(block);
+    MemoryArena* arena = header->arena;
+    if (!arena) {
+        ::operator delete(block);
+        return;
+    }
+    if (arena->generation.load(std::memory_order_acquire) == header->generation) {
+        arena->release_top(block, size + header_size);
+    }
+}
+
+#if ARENA_HAS_COROUTINES
+
+template<typename T>
+class arena_task;
+
+namespace arena_detail {
+
+template<typename T>
+class task_result {
+private:
+    alignas(T) unsigned char storage[sizeof(T)];
+    bool has_value = false;
+protected:
+    std::exception_ptr exception;
+public:
+    task_result() = default;
+    task_result(const task_result&) = delete;
+    task_result& operator=(const task_result&) = delete;
+    ~task_result() {
+        if (has_value) {
+            reinterpret_cast<T*>(storage)->~T();
+        }
+    }
+
+    template<typename U>
+    void return_value(U&& value) {
+        new (storage) T(std::forward<U>(value));
+        has_value = true;
+    }
+    void unhandled_exception() { exception = std::current_exception(); }
+    T& result() {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+        return *reinterpret_cast<T*>(storage);
+    }
+};
+
+template<>
+class task_result<void> {
+protected:
+    std::exception_ptr exception;
+public:
+    void return_void() {}
+    void unhandled_exception() { exception = std::current_exception(); }
+    void result() {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+};
+
+}  // namespace arena_detail
+
+// Lazy coroutine task whose frame lives in a MemoryArena, see
+// ArenaFramePromise. It starts when awaited, or when resume() is called on a
+// top-level task, and resumes its awaiter by symmetric transfer when done.
+// Awaiting a task moves its result out; exceptions are rethrown there.
+template<typename T = void>
+class arena_task {
+public:
+    struct promise_type : ArenaFramePromise, arena_detail::task_result<T> {
+        std::coroutine_handle<> continuation;
+
+        struct final_awaiter {
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                if (std::coroutine_handle<> next = handle.promise().continuation) {
+                    return next;
+                }
+                return std::noop_coroutine();
+            }
+            void await_resume() const noexcept {}
+        };
+
+        arena_task get_return_object() { return arena_task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        final_awaiter final_suspend() const noexcept { return {}; }
+    };
+
+private:
+    std::coroutine_handle<promise_type> handle;
+
+    explicit arena_task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+public:
+    arena_task() = default;
+    arena_task(arena_task&& other) noexcept : handle(other.handle) { other.handle = nullptr; }
+    arena_task& operator=(arena_task&& other) noexcept;
+    ~arena_task();
+
+    arena_task(const arena_task&) = delete;
+    arena_task& operator=(const arena_task&) = delete;
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept;
+    T await_resume();
+
+    // Runs a top-level task until it next suspends; returns true once done.
+    bool resume();
+    bool done() const { return !handle || handle.done(); }
+    // Only valid once done().
+    T result();
+};
+
+template<typename T>
+arena_task<T>& arena_task<T>::operator=(arena_task&& other) noexcept
+{
+    if (this != &other) {
+        if (handle) {
+            handle.destroy();
+        }
+        handle = other.handle;
+        other.handle = nullptr;
+    }
+    return *this;
+}
+
+template<typename T>
+arena_task<T>::~arena_task()
+{
+    if (handle) {
+        handle.destroy();
+    }
+}
+
+template<typename T>
+std::coroutine_handle<> arena_task<T>::await_suspend(std::coroutine_handle<> awaiting) noexcept
+{
+    handle.promise().continuation = awaiting;
+    return handle;
+}
+
+template<typename T>
+T arena_task<T>::await_resume()
+{
+    return result();
+}
+
+template<typename T>
+bool arena_task<T>::resume()
+{
+    if (!done()) {
+        handle.resume();
+    }
+    return done();
+}
+
+template<typename T>
+T arena_task<T>::result()
+{
+    if constexpr (std::is_void_v<T>) {
+        handle.promise().result();
+    } else {
+        return std::move(handle.promise().result());
+    }
+}
+
+#endif // ARENA_HAS_COROUTINES
@@ -0,0 +1,376 @@
+#pragma once
+
+#include "Arena.hpp"
+#include <functional>
+#include <utility>
+
+// Define to 0 to force the scalar control-byte matcher.
+#ifndef ARENA_FLAT_MAP_SSE2
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ARENA_FLAT_MAP_SSE2 1
+#else
+#define ARENA_FLAT_MAP_SSE2 0
+#endif
+#endif
+
+#if ARENA_FLAT_MAP_SSE2
+#include <emmintrin.h>
+#endif
+
+// Open-addressing hash map in the Swiss-table layout whose control bytes and
+// slots live in one MemoryArena reservation, so building it costs a handful
+// of bumps and freeing it is the arena's reset(). Slots are probed in groups
+// of 16 control bytes, matched with SSE2 where available and a scalar loop
+// otherwise. Growth rehashes into a fresh reservation and leaves the old one
+// for reset().
+//
+// An arena reset() empties the map, see BasicArena::generation. Not safe for
+// concurrent use.
+template<typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+class ArenaFlatMap {
+public:
+    struct Entry {
+        K key;
+        V value;
+    };
+
+private:
+    static constexpr size_t group_width = 16;
+    static constexpr int8_t empty_ctrl = -128;
+    static constexpr int8_t deleted_ctrl = -2;
+
+    MemoryArena& arena;
+    int8_t* ctrl;
+    Entry* slots;
+    size_t slot_capacity;    // multiple of group_width, slots and control bytes
+    size_t entry_count;
+    size_t deleted_count;
+    uint64_t arena_generation;
+    Hash hasher;
+    KeyEqual key_equal;
+
+    static size_t mix(size_t hash);
+    static size_t lowest_bit(uint32_t mask);
+    static uint32_t match(const int8_t* group, int8_t value);
+    static uint32_t match_empty_or_deleted(const int8_t* group);
+
+    void check_generation();
+    size_t find_index(const K& key, size_t hash) const;
+    size_t find_free(size_t hash) const;
+    bool rehash(size_t capacity);
+    void destroy_entries();
+public:
+    explicit ArenaFlatMap(MemoryArena& arena, size_t capacity = 0);
+    ~ArenaFlatMap();
+
+    ArenaFlatMap(const ArenaFlatMap&) = delete;
+    ArenaFlatMap& operator=(const ArenaFlatMap&) = delete;
+
+    V* find(const K& key);
+    bool contains(const K& key) { return find(key) != nullptr; }
+    // Returns the value for key and whether it was inserted; the value is
+    // nullptr if the arena could not fit a larger table.
+    template<typename... Args>
+    std::pair<V*, bool> try_emplace(const K& key, Args&&... args);
+    bool erase(const K& key);
+    bool reserve(size_t count);
+    void clear();
+
+    template<typename F>
+    void for_each(F&& f);
+
+    size_t size() const;
+    size_t capacity() const;
+};
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+ArenaFlatMap<K, V, Hash, KeyEqual>::ArenaFlatMap(MemoryArena& arena, size_t capacity)
+    : arena(arena),
+      ctrl(nullptr),
+      slots(nullptr),
+      slot_capacity(0),
+      entry_count(0),
+      deleted_count(0),
+      arena_generation(arena.generation.load(std::memory_order_acquire))
+{
+    if (capacity) {
+        reserve(capacity);
+    }
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+ArenaFlatMap<K, V, Hash, KeyEqual>::~ArenaFlatMap()
+{
+    if (arena.generation.load(std::memory_order_acquire) == arena_generation) {
+        destroy_entries();
+    }
+}
+
+// std::hash is the identity for integers, which would leave the control
+// byte bits constant; a multiplicative mix spreads them.
+template<typename K, typename V, typename Hash, typename KeyEqual>
+size_t ArenaFlatMap<K, V, Hash, KeyEqual>::mix(size_t hash)
+{
+    uint64_t h = static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+    return static_cast<size_t>(h ^ (h >> 32));
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+size_t ArenaFlatMap<K, V, Hash, KeyEqual>::lowest_bit(uint32_t mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<size_t>(__builtin_ctz(mask));
+#else
+    size_t bit = 0;
+    while (!(mask & 1u)) {
+        mask >>= 1;
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+// Bit i of the result is set when group[i] == value.
+template<typename K, typename V, typename Hash, typename KeyEqual>
+uint32_t ArenaFlatMap<K, V, Hash, KeyEqual>::match(const int8_t* group, int8_t value)
+{
+#if ARENA_FLAT_MAP_SSE2
+    __m128i bytes = _mm_load_si128(reinterpret_cast<const __m128i*>(group));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(value))));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < group_width; ++i) {
+        mask |= static_cast<uint32_t>(group[i] == value) << i;
+    }
+    return mask;
+#endif
+}
+
+// Empty and deleted are the only negative control bytes.
+template<typename K, typename V, typename Hash, typename KeyEqual>
+uint32_t ArenaFlatMap<K, V, Hash, KeyEqual>::match_empty_or_deleted(const int8_t* group)
+{
+#if ARENA_FLAT_MAP_SSE2
+    __m128i bytes = _mm_load_si128(reinterpret_cast<const __m128i*>(group));
+    return static_cast<uint32_t>(_mm_movemask_epi8(bytes));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < group_width; ++i) {
+        mask |= static_cast<uint32_t>(group[i] < 0) << i;
+    }
+    return mask;
+#endif
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+void ArenaFlatMap<K, V, Hash, KeyEqual>::check_generation()
+{
+    uint64_t current_generation = arena.generation.load(std::memory_order_acquire);
+    if (current_generation != arena_generation) {
+        ctrl = nullptr;
+        slots = nullptr;
+        slot_capacity = 0;
+        entry_count = 0;
+        deleted_count = 0;
+        arena_generation = current_generation;
+    }
+}
+
+// Groups are visited in triangular order, which covers every group when the
+// group count is a power of two. A group with an empty byte ends the probe.
+template<typename K, typename V, typename Hash, typename KeyEqual>
+size_t ArenaFlatMap<K, V, Hash, KeyEqual>::find_index(const K& key, size_t hash) const
+{
+    if (!slot_capacity) {
+        return SIZE_MAX;
+    }
+    const size_t group_mask = slot_capacity / group_width - 1;
+    const int8_t h2 = static_cast<int8_t>(hash & 0x7F);
+    size_t group = (hash >> 7) & group_mask;
+    for (size_t step = 1; step <= group_mask + 1; ++step) {
+        const int8_t* bytes = ctrl + group * group_width;
+        for (uint32_t mask = match(bytes, h2); mask; mask &= mask - 1) {
+            size_t index = group * group_width + lowest_bit(mask);
+            if (key_equal(slots[index].key, key)) {
+                return index;
+            }
+        }
+        if (match(bytes, empty_ctrl)) {
+            return SIZE_MAX;
+        }
+        group = (group + step) & group_mask;
+    }
+    return SIZE_MAX;
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+size_t ArenaFlatMap<K, V, Hash, KeyEqual>::find_free(size_t hash) const
+{
+    const size_t group_mask = slot_capacity / group_width - 1;
+    size_t group = (hash >> 7) & group_mask;
+    for (size_t step = 1;; ++step) {
+        uint32_t mask = match_empty_or_deleted(ctrl + group * group_width);
+        if (mask) {
+            return group * group_width + lowest_bit(mask);
+        }
+        group = (group + step) & group_mask;
+    }
+}
+
+// capacity is a power of two and at least group_width.
+template<typename K, typename V, typename Hash, typename KeyEqual>
+bool ArenaFlatMap<K, V, Hash, KeyEqual>::rehash(size_t capacity)
+{
+    if (capacity > (SIZE_MAX - alignof(Entry)) / (sizeof(Entry) + 1)) {
+        return false;
+    }
+    size_t slots_offset = (capacity + alignof(Entry) - 1) & ~(alignof(Entry) - 1);
+    size_t alignment = alignof(Entry) > group_width ? alignof(Entry) : group_width;
+    char* base = static_cast<char*>(arena.allocate_bytes(slots_offset + capacity * sizeof(Entry), alignment));
+    if (!base) {
+        return false;
+    }
+
+    int8_t* old_ctrl = ctrl;
+    Entry* old_slots = slots;
+    size_t old_capacity = slot_capacity;
+
+    ctrl = reinterpret_cast<int8_t*>(base);
+    slots = reinterpret_cast<Entry*>(base + slots_offset);
+    slot_capacity = capacity;
+    deleted_count = 0;
+    std::memset(ctrl, static_cast<unsigned char>(empty_ctrl), capacity);
+
+    for (size_t i = 0; i < old_capacity; ++i) {
+        if (old_ctrl[i] >= 0) {
+            size_t hash = mix(hasher(old_slots[i].key));
+            size_t index = find_free(hash);
+            ctrl[index] = static_cast<int8_t>(hash & 0x7F);
+            new (&slots[index]) Entry{std::move(old_slots[i].key), std::move(old_slots[i].value)};
+            old_slots[i].~Entry();
+        }
+    }
+    return true;
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+void ArenaFlatMap<K, V, Hash, KeyEqual>::destroy_entries()
+{
+    if constexpr (!std::is_trivially_destructible_v<Entry>) {
+        for (size_t i = 0; i < slot_capacity; ++i) {
+            if (ctrl[i] >= 0) {
+                slots[i].~Entry();
+            }
+        }
+    }
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+V* ArenaFlatMap<K, V, Hash, KeyEqual>::find(const K& key)
+{
+    check_generation();
+    size_t index = find_index(key, mix(hasher(key)));
+    return index == SIZE_MAX ? nullptr : &slots[index].value;
+}
+
+// Keeps the load, tombstones included, at or below 7/8.
+template<typename K, typename V, typename Hash, typename KeyEqual>
+template<typename... Args>
+std::pair<V*, bool> ArenaFlatMap<K, V, Hash, KeyEqual>::try_emplace(const K& key, Args&&... args)
+{
+    check_generation();
+    size_t hash = mix(hasher(key));
+    size_t index = find_index(key, hash);
+    if (index != SIZE_MAX) {
+        return {&slots[index].value, false};
+    }
+
+    if ((entry_count + deleted_count + 1) * 8 > slot_capacity * 7) {
+        size_t capacity = slot_capacity ? slot_capacity : group_width;
+        while ((entry_count + 1) * 8 > capacity * 7 / 2) {
+            capacity *= 2;
+        }
+        if (!rehash(capacity)) {
+            return {nullptr, false};
+        }
+    }
+
+    index = find_free(hash);
+    if (ctrl[index] == deleted_ctrl) {
+        deleted_count--;
+    }
+    new (&slots[index]) Entry{key, V(std::forward<Args>(args)...)};
+    ctrl[index] = static_cast<int8_t>(hash & 0x7F);
+    entry_count++;
+    return {&slots[index].value, true};
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+bool ArenaFlatMap<K, V, Hash, KeyEqual>::erase(const K& key)
+{
+    check_generation();
+    size_t index = find_index(key, mix(hasher(key)));
+    if (index == SIZE_MAX) {
+        return false;
+    }
+    slots[index].~Entry();
+    ctrl[index] = deleted_ctrl;
+    entry_count--;
+    deleted_count++;
+    return true;
+}
+
+// Makes room for count entries without further growth.
+template<typename K, typename V, typename Hash, typename KeyEqual>
+bool ArenaFlatMap<K, V, Hash, KeyEqual>::reserve(size_t count)
+{
+    check_generation();
+    if (count > SIZE_MAX / 8) {
+        return false;
+    }
+    size_t capacity = group_width;
+    while (count * 8 > capacity * 7) {
+        capacity *= 2;
+    }
+    if (capacity <= slot_capacity) {
+        return true;
+    }
+    return rehash(capacity);
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+void ArenaFlatMap<K, V, Hash, KeyEqual>::clear()
+{
+    check_generation();
+    destroy_entries();
+    if (ctrl) {
+        std::memset(ctrl, static_cast<unsigned char>(empty_ctrl), slot_capacity);
+    }
+    entry_count = 0;
+    deleted_count = 0;
+}
+
+// Calls f(key, value) for every entry in slot order.
+template<typename K, typename V, typename Hash, typename KeyEqual>
+template<typename F>
+void ArenaFlatMap<K, V, Hash, KeyEqual>::for_each(F&& f)
+{
+    check_generation();
+    for (size_t i = 0; i < slot_capacity; ++i) {
+        if (ctrl[i] >= 0) {
+            f(static_cast<const K&>(slots[i].key), slots[i].value);
+        }
+    }
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+size_t ArenaFlatMap<K, V, Hash, KeyEqual>::size() const
+{
+    return arena.generation.load(std::memory_order_acquire) == arena_generation ? entry_count : 0;
+}
+
+template<typename K, typename V, typename Hash, typename KeyEqual>
+size_t ArenaFlatMap<K, V, Hash, KeyEqual>::capacity() const
+{
+    return arena.generation.load(std::memory_order_acquire) == arena_generation ? slot_capacity : 0;
+}
@@ -0,0 +1,416 @@
+#pragma once
+
+#include "Arena.hpp"
+
+// General-purpose heap on top of a MemoryArena with power-of-two size classes
+// from 16 B to 64 KiB. Blocks are carved from the arena in batches and freed
+// blocks go back onto per-class free lists, so allocate/free work in any
+// order. Larger blocks are bumped individually and recycled first-fit.
+//
+// Every block starts with a 16 byte header right in front of the returned
+// pointer that records its class and the offset back to the block start.
+//
+// ThreadCache is the fast path: one per thread, it keeps private free lists
+// and moves blocks to and from the shared lists a batch at a time. An arena
+// reset() or rewind() invalidates the heap and every cache, see
+// BasicArena::generation.
+class ArenaHeap {
+public:
+    static constexpr size_t min_class_size = 16;
+    static constexpr size_t class_count = 13;
+    static constexpr size_t max_class_size = min_class_size << (class_count - 1);
+    static constexpr size_t default_batch_size = 32;
+
+    class ThreadCache;
+
+    explicit ArenaHeap(MemoryArena& arena, size_t batch_size = default_batch_size);
+
+    ArenaHeap(const ArenaHeap&) = delete;
+    ArenaHeap& operator=(const ArenaHeap&) = delete;
+
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+    void free(void* ptr);
+
+    static size_t usable_size(const void* ptr);
+private:
+    struct Header {
+        uint32_t size_class;  // class_count for large blocks
+        uint32_t offset;      // returned pointer minus block start
+        size_t block_size;
+    };
+    static_assert(sizeof(Header) == min_class_size, "header must keep blocks 16 byte aligned");
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    // Written at the start of a freed large block to remember its size.
+    struct LargeFree {
+        Header header;
+        LargeFree* next;
+    };
+
+    MemoryArena& arena;
+    const size_t batch_size;
+    FreeBlock* central[class_count];
+    size_t central_count[class_count];
+    LargeFree* large_free;
+    uint64_t arena_generation;
+    std::mutex heap_mutex;
+
+    static size_t block_size_for(size_t size, size_t alignment);
+    static size_t class_for(size_t block_size);
+    static void* place(char* block, size_t block_size, uint32_t size_class, size_t alignment);
+    static char* block_of(void* ptr);
+
+    void check_generation();
+    FreeBlock* take_batch(size_t size_class, size_t wanted, size_t& taken);
+    void return_batch(size_t size_class, FreeBlock* first, FreeBlock* last, size_t count);
+    void* allocate_block(size_t size, size_t alignment);
+    void* allocate_large(size_t block_size, size_t alignment);
+    void free_large(char* block, size_t block_size);
+};
+
+class ArenaHeap::ThreadCache {
+private:
+    ArenaHeap& heap;
+    FreeBlock* lists[class_count];
+    size_t counts[class_count];
+    uint64_t cache_generation;
+
+    bool check_generation();
+    void* allocate_block(size_t size, size_t alignment);
+public:
+    explicit ThreadCache(ArenaHeap& heap);
+    ~ThreadCache();
+
+    ThreadCache(const ThreadCache&) = delete;
+    ThreadCache& operator=(const ThreadCache&) = delete;
+
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+    void free(void* ptr);
+    void flush();
+};
+
+inline ArenaHeap::ArenaHeap(MemoryArena& arena, size_t batch_size)
+    : arena(arena),
+      batch_size(batch_size ? batch_size : 1),
+      central{},
+      central_count{},
+      large_free(nullptr),
+      arena_generation(arena.generation.load(std::memory_order_acquire))
+{
+}
+
+// Header plus payload plus whatever slack an over-aligned request needs.
+// Returns 0 on overflow or a non power-of-two alignment.
+inline size_t ArenaHeap::block_size_for(size_t size, size_t alignment)
+{
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        return 0;
+    }
+    size_t slack = alignment > min_class_size ? alignment - min_class_size : 0;
+    if (size > SIZE_MAX - sizeof(Header) - slack) {
+        return 0;
+    }
+    size_t needed = size + sizeof(Header) + slack;
+    return (needed + min_class_size - 1) & ~(min_class_size - 1);
+}
+
+inline size_t ArenaHeap::class_for(size_t block_size)
+{
+    size_t size_class = 0;
+    size_t class_size = min_class_size;
+    while (class_size < block_size) {
+        class_size <<= 1;
+        size_class++;
+    }
+    return size_class;
+}
+
+inline void* ArenaHeap::place(char* block, size_t block_size, uint32_t size_class, size_t alignment)
+{
+    uintptr_t addr = reinterpret_cast<uintptr_t>(block) + sizeof(Header);
+    uintptr_t aligned = (addr + alignment - 1) & ~(alignment - 1);
+    char* user = reinterpret_cast<char*>(aligned);
+    Header* header = reinterpret_cast<Header*>(user - sizeof(Header));
+    header->size_class = size_class;
+    header->offset = static_cast<uint32_t>(user - block);
+    header->block_size = block_size;
+    return user;
+}
+
+inline char* ArenaHeap::block_of(void* ptr)
+{
+    const Header* header = reinterpret_cast<const Header*>(static_cast<char*>(ptr) - sizeof(Header));
+    return static_cast<char*>(ptr) - header->offset;
+}
+
+inline size_t ArenaHeap::usable_size(const void* ptr)
+{
+    const Header* header = reinterpret_cast<const Header*>(static_cast<const char*>(ptr) - sizeof(Header));
+    return header->block_size - header->offset;
+}
+
+// Called with heap_mutex held. Blocks handed out before an arena reset are
+// gone, so every list is dropped rather than walked.
+inline void ArenaHeap::check_generation()
+{
+    uint64_t current_generation = arena.generation.load(std::memory_order_acquire);
+    if (current_generation != arena_generation) {
+        for (size_t i = 0; i < class_count; ++i) {
+            central[i] = nullptr;
+            central_count[i] = 0;
+        }
+        large_free = nullptr;
+        arena_generation = current_generation;
+    }
+}
+
+// Called with heap_mutex held. Pops up to wanted blocks of one class, carving
+// a fresh batch from the arena when the shared list is empty.
+inline ArenaHeap::FreeBlock* ArenaHeap::take_batch(size_t size_class, size_t wanted, size_t& taken)
+{
+    if (!central[size_class]) {
+        size_t class_size = min_class_size << size_class;
+        char* slab = arena.bump(batch_size * class_size, min_class_size);
+        if (!slab) {
+            taken = 0;
+            return nullptr;
+        }
+        for (size_t i = batch_size; i > 0; --i) {
+            FreeBlock* block = reinterpret_cast<FreeBlock*>(slab + (i - 1) * class_size);
+            block->next = central[size_class];
+            central[size_class] = block;
+        }
+        central_count[size_class] += batch_size;
+    }
+
+    FreeBlock* first = central[size_class];
+    FreeBlock* last = first;
+    taken = 1;
+    while (taken < wanted && last->next) {
+        last = last->next;
+        taken++;
+    }
+    central[size_class] = last->next;
+    central_count[size_class] -= taken;
+    last->next = nullptr;
+    return first;
+}
+
+// Called with heap_mutex held.
+inline void ArenaHeap::return_batch(size_t size_class, FreeBlock* first, FreeBlock* last, size_t count)
+{
+    last->next = central[size_class];
+    central[size_class] = first;
+    central_count[size_class] += count;
+}
+
+// First fit over the recycled large blocks, then a dedicated bump.
+inline void* ArenaHeap::allocate_large(size_t block_size, size_t alignment)
+{
+    std::lock_guard<std::mutex> lock(heap_mutex);
+    check_generation();
+
+    LargeFree** link = &large_free;
+    while (*link) {
+        LargeFree* free_block = *link;
+        if (free_block->header.block_size >= block_size) {
+            *link = free_block->next;
+            return place(reinterpret_cast<char*>(free_block), free_block->header.block_size,
+                         class_count, alignment);
+        }
+        link = &free_block->next;
+    }
+
+    char* block = arena.bump(block_size, min_class_size);
+    if (!block) {
+        return nullptr;
+    }
+    return place(block, block_size, class_count, alignment);
+}
+
+// Called with heap_mutex held.
+inline void ArenaHeap::free_large(char* block, size_t block_size)
+{
+    LargeFree* free_block = reinterpret_cast<LargeFree*>(block);
+    free_block->header.size_class = class_count;
+    free_block->header.offset = 0;
+    free_block->header.block_size = block_size;
+    free_block->next = large_free;
+    large_free = free_block;
+}
+
+// Each block handed out is reported to the arena's hooks; the batches and
+// large blocks carved from the arena raise no event of their own.
+ARENA_HOOKED_ENTRY inline void* ArenaHeap::allocate(size_t size, size_t alignment)
+{
+    void* ptr = allocate_block(size, alignment);
+    arena.notify_allocation(ptr, size, alignment, ARENA_CALL_SITE());
+    return ptr;
+}
+
+inline void* ArenaHeap::allocate_block(size_t size, size_t alignment)
+{
+    size_t block_size = block_size_for(size, alignment);
+    if (block_size == 0) {
+        return nullptr;
+    }
+    if (block_size > max_class_size) {
+        return allocate_large(block_size, alignment);
+    }
+
+    size_t size_class = class_for(block_size);
+    std::lock_guard<std::mutex> lock(heap_mutex);
+    check_generation();
+    size_t taken;
+    FreeBlock* block = take_batch(size_class, 1, taken);
+    if (!block) {
+        return nullptr;
+    }
+    return place(reinterpret_cast<char*>(block), min_class_size << size_class,
+                 static_cast<uint32_t>(size_class), alignment);
+}
+
+inline void ArenaHeap::free(void* ptr)
+{
+    if (!ptr) return;
+    const Header* header = reinterpret_cast<const Header*>(static_cast<char*>(ptr) - sizeof(Header));
+    char* block = block_of(ptr);
+
+    std::lock_guard<std::mutex> lock(heap_mutex);
+    if (arena.generation.load(std::memory_order_acquire) != arena_generation) {
+        return;
+    }
+    if (header->size_class == class_count) {
+        free_large(block, header->block_size);
+        return;
+    }
+    size_t size_class = header->size_class;
+    FreeBlock* free_block = reinterpret_cast<FreeBlock*>(block);
+    return_batch(size_class, free_block, free_block, 1);
+}
+
+inline ArenaHeap::ThreadCache::ThreadCache(ArenaHeap& heap)
+    : heap(heap),
+      lists{},
+      counts{},
+      cache_generation(heap.arena.generation.load(std::memory_order_acquire))
+{
+}
+
+inline ArenaHeap::ThreadCache::~ThreadCache()
+{
+    flush();
+}
+
+// Drops every cached list after an arena reset; returns false if it did.
+inline bool ArenaHeap::ThreadCache::check_generation()
+{
+    uint64_t current_generation = heap.arena.generation.load(std::memory_order_acquire);
+    if (current_generation != cache_generation) {
+        for (size_t i = 0; i < class_count; ++i) {
+            lists[i] = nullptr;
+            counts[i] = 0;
+        }
+        cache_generation = current_generation;
+        return false;
+    }
+    return true;
+}
+
+ARENA_HOOKED_ENTRY inline void* ArenaHeap::ThreadCache::allocate(size_t size, size_t alignment)
+{
+    void* ptr = allocate_block(size, alignment);
+    heap.arena.notify_allocation(ptr, size, alignment, ARENA_CALL_SITE());
+    return ptr;
+}
+
+// Refills an empty class with one batch from the shared lists.
+inline void* ArenaHeap::ThreadCache::allocate_block(size_t size, size_t alignment)
+{
+    size_t block_size = block_size_for(size, alignment);
+    if (block_size == 0) {
+        return nullptr;
+    }
+    if (block_size > max_class_size) {
+        return heap.allocate_large(block_size, alignment);
+    }
+
+    check_generation();
+    size_t size_class = class_for(block_size);
+    if (!lists[size_class]) {
+        std::lock_guard<std::mutex> lock(heap.heap_mutex);
+        heap.check_generation();
+        size_t taken;
+        lists[size_class] = heap.take_batch(size_class, heap.batch_size, taken);
+        counts[size_class] = taken;
+        if (!lists[size_class]) {
+            return nullptr;
+        }
+    }
+
+    FreeBlock* block = lists[size_class];
+    lists[size_class] = block->next;
+    counts[size_class]--;
+    return place(reinterpret_cast<char*>(block), min_class_size << size_class,
+                 static_cast<uint32_t>(size_class), alignment);
+}
+
+// Once a class holds two batches, one batch goes back to the shared lists.
+// The first free after an arena reset cannot tell a block from before it,
+// whose memory may already be reused, from a new one, so like ArenaHeap::free
+// it drops the block along with the cached lists.
+inline void ArenaHeap::ThreadCache::free(void* ptr)
+{
+    if (!ptr) return;
+    if (!check_generation()) {
+        return;
+    }
+    const Header* header = reinterpret_cast<const Header*>(static_cast<char*>(ptr) - sizeof(Header));
+    if (header->size_class == class_count) {
+        heap.free(ptr);
+        return;
+    }
+
+    size_t size_class = header->size_class;
+    FreeBlock* block = reinterpret_cast<FreeBlock*>(block_of(ptr));
+    block->next = lists[size_class];
+    lists[size_class] = block;
+    counts[size_class]++;
+
+    if (counts[size_class] >= 2 * heap.batch_size) {
+        FreeBlock* first = lists[size_class];
+        FreeBlock* last = first;
+        for (size_t i = 1; i < heap.batch_size; ++i) {
+            last = last->next;
+        }
+        lists[size_class] = last->next;
+        counts[size_class] -= heap.batch_size;
+
+        std::lock_guard<std::mutex> lock(heap.heap_mutex);
+        if (heap.arena.generation.load(std::memory_order_acquire) == heap.arena_generation) {
+            heap.return_batch(size_class, first, last, heap.batch_size);
+        }
+    }
+}
+
+// Hands every cached block back to the shared lists.
+inline void ArenaHeap::ThreadCache::flush()
+{
+    check_generation();
+    std::lock_guard<std::mutex> lock(heap.heap_mutex);
+    bool current = heap.arena.generation.load(std::memory_order_acquire) == heap.arena_generation;
+    for (size_t i = 0; i < class_count; ++i) {
+        if (lists[i] && current) {
+            FreeBlock* last = lists[i];
+            while (last->next) {
+                last = last->next;
+            }
+            heap.return_batch(i, lists[i], last, counts[i]);
+        }
+        lists[i] = nullptr;
+        counts[i] = 0;
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Arena.hpp"
+#include <vector>
+
+// Scheduler for the parallel allocate_array / deallocate_array overloads. A
+// scheduler is any callable taking (size_t task_count, const Task& task) that
+// calls task(i) exactly once for every i below task_count and returns once all
+// calls have finished. Calls may run on any thread, the caller's included, and
+// never throw. A thread pool or std::for_each with a parallel execution policy
+// over the index range fits the same shape.
+//
+// This one starts up to thread_count - 1 threads per call and has the calling
+// thread work alongside them, pulling task indices from a shared counter. If
+// a thread cannot be started the remaining work runs on the threads it has.
+class ArenaThreadScheduler {
+private:
+    unsigned thread_count;
+public:
+    // 0 means std::thread::hardware_concurrency().
+    explicit ArenaThreadScheduler(unsigned threads = 0);
+
+    template<typename Task>
+    void operator()(size_t task_count, const Task& task) const;
+
+    unsigned threads() const { return thread_count; }
+};
+
+inline ArenaThreadScheduler::ArenaThreadScheduler(unsigned threads)
+    : thread_count(threads ? threads : std::thread::hardware_concurrency())
+{
+    if (thread_count == 0) {
+        thread_count = 1;
+    }
+}
+
+template<typename Task>
+void ArenaThreadScheduler::operator()(size_t task_count, const Task& task) const
+{
+    if (task_count == 0) {
+        return;
+    }
+    std::atomic<size_t> next{0};
+    auto work = [&]() {
+        for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < task_count;
+             i = next.fetch_add(1, std::memory_order_relaxed)) {
+            task(i);
+        }
+    };
+
+    size_t helpers = thread_count - 1;
+    if (helpers > task_count - 1) {
+        helpers = task_count - 1;
+    }
+    std::vector<std::thread> workers;
+    try {
+        workers.reserve(helpers);
+        for (size_t i = 0; i < helpers; ++i) {
+            workers.emplace_back(work);
+        }
+    } catch (const std::exception&) {
+    }
+    work();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "Arena.hpp"
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// One mmap-backed MemoryArena per NUMA node, each bound to its node. local()
+// picks the arena of the node the calling thread is currently running on;
+// workers typically wrap it in a ThreadLocalArena once at startup.
+class ArenaSet {
+private:
+    std::vector<std::unique_ptr<MemoryArena>> arenas;
+
+    static size_t detect_node_count();
+public:
+    explicit ArenaSet(size_t size_per_node, ArenaOptions options = ArenaOptions{});
+    ArenaSet(size_t size_per_node, size_t node_count, ArenaOptions options);
+
+    ArenaSet(const ArenaSet&) = delete;
+    ArenaSet& operator=(const ArenaSet&) = delete;
+
+    MemoryArena& local();
+    MemoryArena& node(size_t index) { return *arenas[index]; }
+    size_t node_count() const { return arenas.size(); }
+    void reset();
+
+    static int current_node();
+};
+
+inline ArenaSet::ArenaSet(size_t size_per_node, ArenaOptions options)
+    : ArenaSet(size_per_node, detect_node_count(), options)
+{
+}
+
+inline ArenaSet::ArenaSet(size_t size_per_node, size_t node_count, ArenaOptions options)
+{
+    if (node_count == 0) {
+        node_count = 1;
+    }
+    options.backing = BackingPolicy::Mmap;
+    arenas.reserve(node_count);
+    for (size_t i = 0; i < node_count; ++i) {
+        options.numa_node = static_cast<int>(i);
+        arenas.push_back(std::make_unique<MemoryArena>(size_per_node, options));
+    }
+}
+
+// Parses /sys/devices/system/node/online, e.g. "0" or "0-1,3", and returns the
+// highest node id plus one. Falls back to a single node.
+inline size_t ArenaSet::detect_node_count()
+{
+    std::ifstream online("/sys/devices/system/node/online");
+    std::string ranges;
+    if (!online || !std::getline(online, ranges)) {
+        return 1;
+    }
+
+    size_t highest = 0;
+    size_t value = 0;
+    bool have_value = false;
+    for (char c : ranges) {
+        if (c >= '0' && c <= '9') {
+            value = value * 10 + static_cast<size_t>(c - '0');
+            have_value = true;
+        } else {
+            if (have_value && value > highest) {
+                highest = value;
+            }
+            value = 0;
+            have_value = false;
+        }
+    }
+    if (have_value && value > highest) {
+        highest = value;
+    }
+    return highest + 1;
+}
+
+inline int ArenaSet::current_node()
+{
+#if defined(SYS_getcpu)
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+        return static_cast<int>(node);
+    }
+#endif
+    return 0;
+}
+
+inline MemoryArena& ArenaSet::local()
+{
+    int current = current_node();
+    if (current < 0 || static_cast<size_t>(current) >= arenas.size()) {
+        current = 0;
+    }
+    return *arenas[current];
+}
+
+inline void ArenaSet::reset()
+{
+    for (auto& arena : arenas) {
+        arena->reset();
+    }
+}
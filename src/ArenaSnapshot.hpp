@@ -0,0 +1,199 @@
+#pragma once
+
+#include "Arena.hpp"
+#include <cstdio>
+#include <memory>
+
+#if ARENA_HAS_MMAP
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+// Self-relative pointer: stores the distance from itself to the target, so
+// links between objects of one arena stay valid wherever the arena's bytes are
+// mapped. Null is stored as 0. Copies recompute the distance, which makes the
+// type non-trivially copyable; never memcpy it to a different address.
+template<typename T>
+class arena_offset_ptr {
+private:
+    std::ptrdiff_t offset = 0;
+
+    void set(const T* target) {
+        offset = target ? reinterpret_cast<const char*>(target) - reinterpret_cast<const char*>(this) : 0;
+    }
+public:
+    arena_offset_ptr() = default;
+    arena_offset_ptr(T* target) { set(target); }
+    arena_offset_ptr(const arena_offset_ptr& other) { set(other.get()); }
+    arena_offset_ptr& operator=(const arena_offset_ptr& other) { set(other.get()); return *this; }
+    arena_offset_ptr& operator=(T* target) { set(target); return *this; }
+
+    T* get() const {
+        if (!offset) {
+            return nullptr;
+        }
+        return reinterpret_cast<T*>(const_cast<char*>(reinterpret_cast<const char*>(this)) + offset);
+    }
+    T* operator->() const { return get(); }
+    T& operator*() const { return *get(); }
+    T& operator[](size_t index) const { return get()[index]; }
+    explicit operator bool() const { return offset != 0; }
+};
+
+// Writes the used bytes of a single-block arena to a file and maps them back
+// into a new MemoryArena, so immutable structures built once can be reused on
+// a warm restart without rebuilding them. Links inside the arena must be
+// arena_offset_ptr, and every object must be trivially destructible since no
+// finalizers survive the round trip.
+//
+// The file holds a header page followed by the block's bytes, shifted so they
+// keep their offset within a page, which preserves every alignment up to the
+// page size. load() maps them MAP_PRIVATE: pages come straight from the page
+// cache and are only copied if written. The loaded block is full; further
+// allocations chain new blocks per the options, and reset() reuses it.
+class ArenaSnapshot {
+private:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t page_offset;    // base address modulo data_offset when saved
+        uint64_t data_offset;    // file offset of the data, the saving system's page size
+        uint64_t used;
+        uint64_t root_offset;    // UINT64_MAX when no root was given
+    };
+
+    static constexpr char magic[8] = {'A', 'R', 'E', 'N', 'A', 'S', 'N', 'P'};
+    static constexpr uint32_t version = 1;
+
+    static MemoryArena::Block* map_block(const char* path, const Header& header);
+public:
+    // Returns false if the arena is empty, has chained blocks, hot, large or
+    // non-trivial objects, root lies outside the used range, or the file
+    // cannot be written. Allocation must be quiescent while saving.
+    static bool save(MemoryArena& arena, const char* path, const void* root = nullptr);
+    // Returns nullptr if the file is missing, malformed or cannot be mapped.
+    // root receives the pointer passed to save(), relocated.
+    static std::unique_ptr<MemoryArena> load(const char* path, void** root = nullptr,
+                                             const ArenaOptions& options = ArenaOptions{});
+};
+
+inline bool ArenaSnapshot::save(MemoryArena& arena, const char* path, const void* root)
+{
+    std::lock_guard<MutexLock> lock(arena.arena_mutex);
+    MemoryArena::Block* block = arena.current_block.load(std::memory_order_acquire);
+    if (block != arena.head || arena.finalizers.load(std::memory_order_acquire) ||
+        (arena.hot && arena.hot->cursor.load(std::memory_order_acquire) != arena.hot->base) ||
+        arena.large_blocks) {
+        return false;
+    }
+    const char* base = block->base;
+    size_t used = static_cast<size_t>(block->cursor.load(std::memory_order_acquire) - base);
+    if (used == 0) {
+        return false;
+    }
+    const char* root_ptr = static_cast<const char*>(root);
+    if (root_ptr && (root_ptr < base || root_ptr >= base + used)) {
+        return false;
+    }
+
+    size_t page = MemoryArena::page_size();
+    Header header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.page_offset = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(base) & (page - 1));
+    header.data_offset = page;
+    header.used = used;
+    header.root_offset = root_ptr ? static_cast<uint64_t>(root_ptr - base) : UINT64_MAX;
+
+    std::FILE* file = std::fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    size_t padding = static_cast<size_t>(header.data_offset) + header.page_offset - sizeof(header);
+    for (size_t i = 0; ok && i < padding; ++i) {
+        ok = std::fputc(0, file) != EOF;
+    }
+    if (ok) {
+        ok = std::fwrite(base, 1, used, file) == used;
+    }
+    ok = std::fclose(file) == 0 && ok;
+    return ok;
+}
+
+// Maps the data pages, or reads them into a heap block when mmap is not
+// available or the saving system used a different page size.
+inline MemoryArena::Block* ArenaSnapshot::map_block(const char* path, const Header& header)
+{
+    size_t length = static_cast<size_t>(header.page_offset + header.used);
+#if ARENA_HAS_MMAP
+    if (header.data_offset % MemoryArena::page_size() == 0) {
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            return nullptr;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || static_cast<uint64_t>(info.st_size) < header.data_offset + length) {
+            close(fd);
+            return nullptr;
+        }
+        void* mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd,
+                             static_cast<off_t>(header.data_offset));
+        close(fd);
+        if (mapping == MAP_FAILED) {
+            return nullptr;
+        }
+        char* base = static_cast<char*>(mapping) + header.page_offset;
+        size_t size = static_cast<size_t>(header.used);
+        return new MemoryArena::Block{base, size, {base + size}, nullptr, {base + size}, mapping, length};
+    }
+#endif
+    // Heap storage is aligned to a cache line, so the data keeps its alignment
+    // as long as the saved base was aligned at least that much.
+    if (header.page_offset % arena_cache_line_size != 0) {
+        return nullptr;
+    }
+    size_t size = static_cast<size_t>(header.used);
+    char* storage = MemoryArena::allocate_storage(size);
+    if (!storage) {
+        return nullptr;
+    }
+    std::FILE* file = std::fopen(path, "rb");
+    bool ok = file && std::fseek(file, static_cast<long>(header.data_offset + header.page_offset), SEEK_SET) == 0 &&
+              std::fread(storage, 1, size, file) == size;
+    if (file) {
+        std::fclose(file);
+    }
+    if (!ok) {
+        MemoryArena::free_storage(storage);
+        return nullptr;
+    }
+    (void)length;
+    return new MemoryArena::Block{storage, size, {storage + size}, nullptr, {storage + size}, nullptr, 0};
+}
+
+inline std::unique_ptr<MemoryArena> ArenaSnapshot::load(const char* path, void** root, const ArenaOptions& options)
+{
+    Header header;
+    std::FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        return nullptr;
+    }
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1;
+    std::fclose(file);
+    if (!ok || std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != version ||
+        header.used == 0 || header.data_offset < sizeof(header) || header.page_offset >= header.data_offset ||
+        (header.root_offset != UINT64_MAX && header.root_offset >= header.used)) {
+        return nullptr;
+    }
+
+    MemoryArena::Block* block = map_block(path, header);
+    if (!block) {
+        return nullptr;
+    }
+    std::unique_ptr<MemoryArena> arena(new MemoryArena(block, options));
+    if (root) {
+        *root = header.root_offset == UINT64_MAX ? nullptr : block->base + header.root_offset;
+    }
+    return arena;
+}
@@ -0,0 +1,227 @@
+#pragma once
+
+#include "Arena.hpp"
+#include <tuple>
+
+// Structure-of-arrays table on top of a MemoryArena: one contiguous column per
+// field, all carved from a single allocate_bytes reservation. Every column
+// starts on a column_alignment boundary and is padded to a multiple of it, so
+// a scan over one field touches only that field's cache lines and loops over
+// column<I>() vectorize without peeling for alignment.
+//
+// Fields must be trivially copyable and destructible since rows are moved
+// with memcpy and never finalized. Growing moves the columns to a fresh
+// reservation and leaves the old one for the arena's reset(). An arena reset()
+// empties the table, see BasicArena::generation. Not safe for concurrent use.
+template<typename... Fields>
+class ArenaSoA {
+    static_assert(sizeof...(Fields) > 0, "ArenaSoA needs at least one field");
+    static_assert((std::is_trivially_copyable_v<Fields> && ...), "ArenaSoA fields must be trivially copyable");
+    static_assert((std::is_trivially_destructible_v<Fields> && ...), "ArenaSoA fields must be trivially destructible");
+public:
+    static constexpr size_t column_alignment = 64;
+    static constexpr size_t field_count = sizeof...(Fields);
+
+    template<size_t I>
+    using field_type = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+private:
+    MemoryArena& arena;
+    void* columns[field_count];
+    size_t row_count;
+    size_t row_capacity;
+    uint64_t arena_generation;
+
+    static size_t column_bytes(size_t size, size_t capacity);
+    static bool layout(size_t capacity, size_t* offsets, size_t& total);
+    void check_generation();
+    template<size_t... I>
+    void push_row(std::index_sequence<I...>, const Fields&... values);
+    template<size_t... I>
+    void copy_rows(std::index_sequence<I...>, size_t count, const Fields*... sources);
+public:
+    explicit ArenaSoA(MemoryArena& arena, size_t capacity = 0);
+
+    ArenaSoA(const ArenaSoA&) = delete;
+    ArenaSoA& operator=(const ArenaSoA&) = delete;
+
+    // Returns false, leaving the table as it was, if the arena cannot fit it.
+    bool reserve(size_t capacity);
+    bool push_back(const Fields&... values);
+    // Appends count rows taken from one source array per field.
+    bool append(size_t count, const Fields*... sources);
+    void clear() { row_count = 0; }
+
+    template<size_t I>
+    field_type<I>* column();
+    template<size_t I>
+    const field_type<I>* column() const;
+    template<size_t I>
+    field_type<I>& at(size_t row) { return column<I>()[row]; }
+
+    size_t size() const;
+    size_t capacity() const;
+};
+
+template<typename... Fields>
+ArenaSoA<Fields...>::ArenaSoA(MemoryArena& arena, size_t capacity)
+    : arena(arena),
+      columns{},
+      row_count(0),
+      row_capacity(0),
+      arena_generation(arena.generation.load(std::memory_order_acquire))
+{
+    if (capacity) {
+        reserve(capacity);
+    }
+}
+
+template<typename... Fields>
+size_t ArenaSoA<Fields...>::column_bytes(size_t size, size_t capacity)
+{
+    if (capacity > (SIZE_MAX - column_alignment) / size) {
+        return SIZE_MAX;
+    }
+    return (capacity * size + column_alignment - 1) & ~(column_alignment - 1);
+}
+
+template<typename... Fields>
+bool ArenaSoA<Fields...>::layout(size_t capacity, size_t* offsets, size_t& total)
+{
+    total = 0;
+    size_t index = 0;
+    bool fits = true;
+    for (size_t size : {sizeof(Fields)...}) {
+        size_t bytes = column_bytes(size, capacity);
+        if (bytes == SIZE_MAX || bytes > SIZE_MAX - total) {
+            fits = false;
+            break;
+        }
+        offsets[index++] = total;
+        total += bytes;
+    }
+    return fits;
+}
+
+// Memory from before an arena reset is gone, so the table starts over.
+template<typename... Fields>
+void ArenaSoA<Fields...>::check_generation()
+{
+    uint64_t current_generation = arena.generation.load(std::memory_order_acquire);
+    if (current_generation != arena_generation) {
+        for (void*& column : columns) {
+            column = nullptr;
+        }
+        row_count = 0;
+        row_capacity = 0;
+        arena_generation = current_generation;
+    }
+}
+
+template<typename... Fields>
+bool ArenaSoA<Fields...>::reserve(size_t capacity)
+{
+    check_generation();
+    if (capacity <= row_capacity) {
+        return true;
+    }
+    size_t offsets[field_count];
+    size_t total;
+    if (!layout(capacity, offsets, total)) {
+        return false;
+    }
+    char* base = static_cast<char*>(arena.allocate_bytes(total, column_alignment));
+    if (!base) {
+        return false;
+    }
+
+    size_t index = 0;
+    for (size_t size : {sizeof(Fields)...}) {
+        if (row_count) {
+            std::memcpy(base + offsets[index], columns[index], row_count * size);
+        }
+        columns[index] = base + offsets[index];
+        ++index;
+    }
+    row_capacity = capacity;
+    return true;
+}
+
+template<typename... Fields>
+template<size_t... I>
+void ArenaSoA<Fields...>::push_row(std::index_sequence<I...>, const Fields&... values)
+{
+    ((static_cast<Fields*>(columns[I])[row_count] = values), ...);
+}
+
+template<typename... Fields>
+template<size_t... I>
+void ArenaSoA<Fields...>::copy_rows(std::index_sequence<I...>, size_t count, const Fields*... sources)
+{
+    (std::memcpy(static_cast<Fields*>(columns[I]) + row_count, sources, count * sizeof(Fields)), ...);
+}
+
+// Doubles the capacity when full.
+template<typename... Fields>
+bool ArenaSoA<Fields...>::push_back(const Fields&... values)
+{
+    check_generation();
+    if (row_count == row_capacity && !reserve(row_capacity ? row_capacity * 2 : 16)) {
+        return false;
+    }
+    push_row(std::index_sequence_for<Fields...>{}, values...);
+    ++row_count;
+    return true;
+}
+
+template<typename... Fields>
+bool ArenaSoA<Fields...>::append(size_t count, const Fields*... sources)
+{
+    check_generation();
+    if (count == 0) {
+        return true;
+    }
+    if (count > SIZE_MAX - row_count) {
+        return false;
+    }
+    size_t needed = row_count + count;
+    if (needed > row_capacity) {
+        size_t grown = row_capacity > SIZE_MAX / 2 ? SIZE_MAX : row_capacity * 2;
+        if (!reserve(grown > needed ? grown : needed) && !reserve(needed)) {
+            return false;
+        }
+    }
+    copy_rows(std::index_sequence_for<Fields...>{}, count, sources...);
+    row_count = needed;
+    return true;
+}
+
+template<typename... Fields>
+template<size_t I>
+typename ArenaSoA<Fields...>::template field_type<I>* ArenaSoA<Fields...>::column()
+{
+    check_generation();
+    return static_cast<field_type<I>*>(columns[I]);
+}
+
+template<typename... Fields>
+template<size_t I>
+const typename ArenaSoA<Fields...>::template field_type<I>* ArenaSoA<Fields...>::column() const
+{
+    if (arena.generation.load(std::memory_order_acquire) != arena_generation) {
+        return nullptr;
+    }
+    return static_cast<const field_type<I>*>(columns[I]);
+}
+
+template<typename... Fields>
+size_t ArenaSoA<Fields...>::size() const
+{
+    return arena.generation.load(std::memory_order_acquire) == arena_generation ? row_count : 0;
+}
+
+template<typename... Fields>
+size_t ArenaSoA<Fields...>::capacity() const
+{
+    return arena.generation.load(std::memory_order_acquire) == arena_generation ? row_capacity : 0;
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "Arena.hpp"
+#include "ArenaFlatMap.hpp"
+#include <string_view>
+
+// Deduplicates strings into a MemoryArena. The bytes of every distinct string
+// are copied once into arena chunks, the lookup table is an ArenaFlatMap and
+// the id-to-string table an arena array, so nothing touches the heap and the
+// whole interner is freed by the arena's reset(), see BasicArena::generation.
+// Returned views stay valid until then. Not safe for concurrent use.
+class ArenaStringInterner {
+private:
+    MemoryArena& arena;
+    ArenaFlatMap<std::string_view, uint32_t> ids;
+    std::string_view* strings;
+    size_t string_capacity;
+    size_t string_count;
+    char* chunk_base;
+    size_t chunk_used;
+    size_t chunk_capacity;
+    const size_t chunk_size;
+    uint64_t arena_generation;
+
+    void check_generation();
+    char* store(std::string_view text);
+public:
+    static constexpr size_t default_chunk_size = 4096;
+    static constexpr uint32_t npos = UINT32_MAX;
+
+    explicit ArenaStringInterner(MemoryArena& arena, size_t chunk_size = default_chunk_size);
+
+    ArenaStringInterner(const ArenaStringInterner&) = delete;
+    ArenaStringInterner& operator=(const ArenaStringInterner&) = delete;
+
+    // Returns the id of text, interning it first if needed; npos if the arena
+    // is out of memory.
+    uint32_t intern_id(std::string_view text);
+    // Empty view with a null data() if the arena is out of memory.
+    std::string_view intern(std::string_view text);
+    uint32_t find(std::string_view text);
+    std::string_view lookup(uint32_t id) const { return strings[id]; }
+
+    size_t size() const;
+};
+
+inline ArenaStringInterner::ArenaStringInterner(MemoryArena& arena, size_t chunk_size)
+    : arena(arena),
+      ids(arena),
+      strings(nullptr),
+      string_capacity(0),
+      string_count(0),
+      chunk_base(nullptr),
+      chunk_used(0),
+      chunk_capacity(0),
+      chunk_size(chunk_size ? chunk_size : default_chunk_size),
+      arena_generation(arena.generation.load(std::memory_order_acquire))
+{
+}
+
+inline void ArenaStringInterner::check_generation()
+{
+    uint64_t current_generation = arena.generation.load(std::memory_order_acquire);
+    if (current_generation != arena_generation) {
+        strings = nullptr;
+        string_capacity = 0;
+        string_count = 0;
+        chunk_base = nullptr;
+        chunk_used = 0;
+        chunk_capacity = 0;
+        arena_generation = current_generation;
+    }
+}
+
+// Copies text into the current chunk. A full chunk is first grown in place
+// with try_extend, which succeeds while nothing else has been bumped after it;
+// otherwise a new chunk is started and the old tail is left unused.
+inline char* ArenaStringInterner::store(std::string_view text)
+{
+    size_t size = text.size();
+    if (size > chunk_capacity - chunk_used) {
+        size_t grow = size > chunk_size ? size : chunk_size;
+        if (chunk_base && arena.try_extend(chunk_base, chunk_capacity, chunk_capacity + grow)) {
+            chunk_capacity += grow;
+        } else {
+            char* chunk = static_cast<char*>(arena.allocate_bytes(grow, 1));
+            if (!chunk) {
+                return nullptr;
+            }
+            chunk_base = chunk;
+            chunk_used = 0;
+            chunk_capacity = grow;
+        }
+    }
+    char* copy = chunk_base + chunk_used;
+    std::memcpy(copy, text.data(), size);
+    chunk_used += size;
+    return copy;
+}
+
+inline uint32_t ArenaStringInterner::intern_id(std::string_view text)
+{
+    check_generation();
+    if (uint32_t* id = ids.find(text)) {
+        return *id;
+    }
+    if (string_count == npos) {
+        return npos;
+    }
+
+    if (string_count == string_capacity) {
+        size_t capacity = string_capacity ? string_capacity * 2 : 16;
+        std::string_view* grown = arena.reallocate_array<std::string_view>(strings, string_capacity, capacity);
+        if (!grown) {
+            return npos;
+        }
+        strings = grown;
+        string_capacity = capacity;
+    }
+
+    const char* copy = text.empty() ? "" : store(text);
+    if (!copy) {
+        return npos;
+    }
+    std::string_view stored(copy, text.size());
+    uint32_t id = static_cast<uint32_t>(string_count);
+    if (!ids.try_emplace(stored, id).first) {
+        return npos;
+    }
+    strings[string_count++] = stored;
+    return id;
+}
+
+inline std::string_view ArenaStringInterner::intern(std::string_view text)
+{
+    uint32_t id = intern_id(text);
+    return id == npos ? std::string_view() : strings[id];
+}
+
+inline uint32_t ArenaStringInterner::find(std::string_view text)
+{
+    check_generation();
+    uint32_t* id = ids.find(text);
+    return id ? *id : npos;
+}
+
+inline size_t ArenaStringInterner::size() const
+{
+    return arena.generation.load(std::memory_order_acquire) == arena_generation ? string_count : 0;
+}
@@ -0,0 +1,386 @@
+#pragma once
+
+#include "Arena.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Ring buffer of arena events fed through ArenaHooks. Install it on one or
+// more arenas built with ARENA_ENABLE_HOOKS=1; the newest capacity events are
+// kept. Each event records the call site address and the ArenaTraceLabel
+// scopes active on the recording thread, so exports can attribute bytes to
+// named phases as well as to code addresses (resolve those with addr2line).
+//
+// Recording is wait-free: every event claims its own slot with a fetch_add.
+// Exports read the slots without synchronization and must not run while an
+// installed arena is still allocating.
+//
+// write_binary() keeps only what a replay needs (see replay_arena.cpp) in a
+// compact varint encoding, a few bytes per event: events stay in recording
+// order and arenas are numbered by first appearance. Frees and rewinds raise
+// no events, so a trace does not show memory being handed back.
+class ArenaTraceRecorder {
+public:
+    static constexpr size_t max_label_depth = 8;
+
+    struct Event {
+        uint64_t timestamp_ns;       // since the recorder was created
+        const void* arena;
+        ArenaEvent kind;
+        const void* ptr;
+        size_t size;
+        size_t alignment;
+        const void* call_site;
+        uint32_t thread;             // small per-process thread number
+        uint32_t label_depth;
+        const char* labels[max_label_depth];  // outermost first
+    };
+
+    // Event as stored by write_binary().
+    struct Record {
+        uint64_t timestamp_ns;
+        uint32_t thread;
+        uint32_t arena;              // 0 for the first arena seen, and so on
+        ArenaEvent kind;
+        uint64_t size;
+        uint64_t alignment;
+    };
+
+private:
+    std::vector<Event> events;
+    size_t mask;
+    std::atomic<uint64_t> next{0};
+    std::chrono::steady_clock::time_point start;
+    ArenaHooks arena_hooks;
+
+    static void on_event(void* context, const void* arena, ArenaEvent kind,
+                         const void* ptr, size_t size, size_t alignment, const void* call_site);
+    static uint32_t thread_number();
+    static void write_json_string(std::ostream& out, const char* text);
+    static void write_varint(std::ostream& out, uint64_t value);
+    static bool read_varint(std::istream& in, uint64_t& value);
+
+    static constexpr char binary_magic[8] = {'A', 'R', 'E', 'N', 'A', 'T', 'R', 'C'};
+    static constexpr uint32_t binary_version = 1;
+
+    friend class ArenaTraceLabel;
+    struct LabelStack {
+        const char* labels[max_label_depth];
+        uint32_t depth;
+    };
+    static LabelStack& label_stack();
+public:
+    // capacity is rounded up to a power of two
+    explicit ArenaTraceRecorder(size_t capacity = 1 << 16);
+
+    ArenaTraceRecorder(const ArenaTraceRecorder&) = delete;
+    ArenaTraceRecorder& operator=(const ArenaTraceRecorder&) = delete;
+
+    const ArenaHooks* hooks() const { return &arena_hooks; }
+    template<typename Arena>
+    void attach(Arena& arena) { arena.set_hooks(&arena_hooks); }
+    template<typename Arena>
+    void detach(Arena& arena) { arena.set_hooks(nullptr); }
+
+    size_t capacity() const { return events.size(); }
+    size_t size() const;
+    uint64_t dropped() const;
+    std::vector<Event> snapshot() const;
+    void clear() { next.store(0, std::memory_order_relaxed); }
+
+    // Chrome trace event format, loadable in chrome://tracing and Perfetto.
+    void write_chrome_trace(std::ostream& out) const;
+    // One "label;label;call_site bytes" line per distinct stack, for
+    // flamegraph.pl and similar tools. Failed allocations count under a
+    // trailing "[failed]" frame.
+    void write_folded_stacks(std::ostream& out) const;
+
+    // Return false on a stream error; read_binary() also on malformed input,
+    // in which case records is left empty.
+    bool write_binary(std::ostream& out) const;
+    static bool write_records(std::ostream& out, const std::vector<Record>& records);
+    static bool read_binary(std::istream& in, std::vector<Record>& records);
+};
+
+// Names the enclosing scope in recorded events on this thread. The label must
+// outlive the recorder's exports, which string literals do. Scopes nested
+// deeper than max_label_depth are not recorded.
+class ArenaTraceLabel {
+public:
+    explicit ArenaTraceLabel(const char* label);
+    ~ArenaTraceLabel();
+
+    ArenaTraceLabel(const ArenaTraceLabel&) = delete;
+    ArenaTraceLabel& operator=(const ArenaTraceLabel&) = delete;
+};
+
+inline ArenaTraceRecorder::ArenaTraceRecorder(size_t capacity)
+    : start(std::chrono::steady_clock::now())
+{
+    size_t rounded = 1;
+    while (rounded < capacity) {
+        rounded <<= 1;
+    }
+    events.resize(rounded);
+    mask = rounded - 1;
+    arena_hooks.on_event = &ArenaTraceRecorder::on_event;
+    arena_hooks.context = this;
+}
+
+inline ArenaTraceRecorder::LabelStack& ArenaTraceRecorder::label_stack()
+{
+    thread_local LabelStack stack{};
+    return stack;
+}
+
+inline uint32_t ArenaTraceRecorder::thread_number()
+{
+    static std::atomic<uint32_t> threads{0};
+    thread_local uint32_t number = threads.fetch_add(1, std::memory_order_relaxed) + 1;
+    return number;
+}
+
+inline void ArenaTraceRecorder::on_event(void* context, const void* arena, ArenaEvent kind,
+                                         const void* ptr, size_t size, size_t alignment, const void* call_site)
+{
+    ArenaTraceRecorder* self = static_cast<ArenaTraceRecorder*>(context);
+    uint64_t index = self->next.fetch_add(1, std::memory_order_relaxed);
+    Event& event = self->events[index & self->mask];
+
+    event.timestamp_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - self->start).count());
+    event.arena = arena;
+    event.kind = kind;
+    event.ptr = ptr;
+    event.size = size;
+    event.alignment = alignment;
+    event.call_site = call_site;
+    event.thread = thread_number();
+
+    const LabelStack& stack = label_stack();
+    uint32_t depth = stack.depth < max_label_depth ? stack.depth : max_label_depth;
+    event.label_depth = depth;
+    for (uint32_t i = 0; i < depth; ++i) {
+        event.labels[i] = stack.labels[i];
+    }
+}
+
+inline size_t ArenaTraceRecorder::size() const
+{
+    uint64_t recorded = next.load(std::memory_order_acquire);
+    return recorded < events.size() ? static_cast<size_t>(recorded) : events.size();
+}
+
+inline uint64_t ArenaTraceRecorder::dropped() const
+{
+    uint64_t recorded = next.load(std::memory_order_acquire);
+    return recorded > events.size() ? recorded - events.size() : 0;
+}
+
+// Oldest event first.
+inline std::vector<ArenaTraceRecorder::Event> ArenaTraceRecorder::snapshot() const
+{
+    uint64_t recorded = next.load(std::memory_order_acquire);
+    uint64_t first = recorded > events.size() ? recorded - events.size() : 0;
+    std::vector<Event> result;
+    result.reserve(static_cast<size_t>(recorded - first));
+    for (uint64_t i = first; i < recorded; ++i) {
+        result.push_back(events[i & mask]);
+    }
+    return result;
+}
+
+inline void ArenaTraceRecorder::write_json_string(std::ostream& out, const char* text)
+{
+    out << '"';
+    for (const char* c = text; *c; ++c) {
+        unsigned char ch = static_cast<unsigned char>(*c);
+        if (ch == '"' || ch == '\\') {
+            out << '\\' << *c;
+        } else if (ch < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", ch);
+            out << escaped;
+        } else {
+            out << *c;
+        }
+    }
+    out << '"';
+}
+
+// Allocations and failures become thread-scoped instant events named after
+// the innermost label; resets are process-scoped so they show as a line
+// across every track. Arenas are told apart through args.arena.
+inline void ArenaTraceRecorder::write_chrome_trace(std::ostream& out) const
+{
+    std::vector<Event> recorded = snapshot();
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    for (const Event& event : recorded) {
+        if (!first) {
+            out << ',';
+        }
+        first = false;
+
+        const char* name = event.kind == ArenaEvent::Reset ? "reset"
+            : event.label_depth ? event.labels[event.label_depth - 1]
+            : event.kind == ArenaEvent::Failure ? "failed allocation" : "allocate";
+        char timestamp[32];
+        std::snprintf(timestamp, sizeof(timestamp), "%.3f", static_cast<double>(event.timestamp_ns) / 1000.0);
+        char addresses[64];
+        std::snprintf(addresses, sizeof(addresses), "\"arena\":\"%p\",\"call_site\":\"%p\"",
+                      event.arena, event.call_site);
+
+        out << "\n{\"name\":";
+        write_json_string(out, name);
+        out << ",\"cat\":\"arena\",\"ph\":\"i\",\"s\":\"" << (event.kind == ArenaEvent::Reset ? 'p' : 't')
+            << "\",\"ts\":" << timestamp << ",\"pid\":1,\"tid\":" << event.thread
+            << ",\"args\":{" << addresses;
+        if (event.kind != ArenaEvent::Reset) {
+            out << ",\"size\":" << event.size << ",\"alignment\":" << event.alignment
+                << ",\"failed\":" << (event.kind == ArenaEvent::Failure ? "true" : "false");
+        }
+        out << "}}";
+    }
+    out << "\n]}\n";
+}
+
+inline void ArenaTraceRecorder::write_folded_stacks(std::ostream& out) const
+{
+    std::map<std::string, uint64_t> stacks;
+    for (const Event& event : snapshot()) {
+        if (event.kind == ArenaEvent::Reset) {
+            continue;
+        }
+        std::string stack;
+        for (uint32_t i = 0; i < event.label_depth; ++i) {
+            stack += event.labels[i];
+            stack += ';';
+        }
+        char address[32];
+        std::snprintf(address, sizeof(address), "%p", event.call_site);
+        stack += address;
+        if (event.kind == ArenaEvent::Failure) {
+            stack += ";[failed]";
+        }
+        stacks[stack] += event.size;
+    }
+    for (const auto& entry : stacks) {
+        out << entry.first << ' ' << entry.second << '\n';
+    }
+}
+
+inline void ArenaTraceRecorder::write_varint(std::ostream& out, uint64_t value)
+{
+    while (value >= 0x80) {
+        out.put(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.put(static_cast<char>(value));
+}
+
+inline bool ArenaTraceRecorder::read_varint(std::istream& in, uint64_t& value)
+{
+    value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        int byte = in.get();
+        if (byte == std::istream::traits_type::eof()) {
+            return false;
+        }
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool ArenaTraceRecorder::write_binary(std::ostream& out) const
+{
+    std::vector<Event> recorded = snapshot();
+    std::unordered_map<const void*, uint32_t> arena_numbers;
+    std::vector<Record> records;
+    records.reserve(recorded.size());
+    for (const Event& event : recorded) {
+        auto number = arena_numbers.emplace(event.arena, static_cast<uint32_t>(arena_numbers.size())).first;
+        records.push_back(Record{event.timestamp_ns, event.thread, number->second, event.kind,
+                                 event.size, event.alignment});
+    }
+    return write_records(out, records);
+}
+
+// Header: magic, version and event count. Each event is then a zigzag varint
+// timestamp delta (slots are claimed before the clock is read, so deltas can
+// be negative), thread, arena, kind, size and log2 of the alignment.
+inline bool ArenaTraceRecorder::write_records(std::ostream& out, const std::vector<Record>& records)
+{
+    out.write(binary_magic, sizeof(binary_magic));
+    write_varint(out, binary_version);
+    write_varint(out, records.size());
+    uint64_t previous = 0;
+    for (const Record& record : records) {
+        int64_t delta = static_cast<int64_t>(record.timestamp_ns - previous);
+        previous = record.timestamp_ns;
+        write_varint(out, (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63));
+        write_varint(out, record.thread);
+        write_varint(out, record.arena);
+        out.put(static_cast<char>(record.kind));
+        write_varint(out, record.size);
+        unsigned shift = 0;
+        while (shift < 63 && (uint64_t(1) << shift) < record.alignment) {
+            ++shift;
+        }
+        out.put(static_cast<char>(shift));
+    }
+    return static_cast<bool>(out);
+}
+
+inline bool ArenaTraceRecorder::read_binary(std::istream& in, std::vector<Record>& records)
+{
+    records.clear();
+    char magic[sizeof(binary_magic)];
+    uint64_t version = 0;
+    uint64_t count = 0;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, binary_magic, sizeof(magic)) != 0 ||
+        !read_varint(in, version) || version != binary_version || !read_varint(in, count)) {
+        return false;
+    }
+
+    uint64_t timestamp = 0;
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t delta, thread, arena, size;
+        int kind, shift;
+        if (!read_varint(in, delta) || !read_varint(in, thread) || !read_varint(in, arena) ||
+            (kind = in.get()) > static_cast<int>(ArenaEvent::Reset) || kind < 0 ||
+            !read_varint(in, size) || (shift = in.get()) < 0 || shift > 63 ||
+            thread > UINT32_MAX || arena > UINT32_MAX) {
+            records.clear();
+            return false;
+        }
+        timestamp += static_cast<uint64_t>(static_cast<int64_t>(delta >> 1) ^ -static_cast<int64_t>(delta & 1));
+        records.push_back(Record{timestamp, static_cast<uint32_t>(thread), static_cast<uint32_t>(arena),
+                                 static_cast<ArenaEvent>(kind), size, uint64_t(1) << shift});
+    }
+    return true;
+}
+
+inline ArenaTraceLabel::ArenaTraceLabel(const char* label)
+{
+    ArenaTraceRecorder::LabelStack& stack = ArenaTraceRecorder::label_stack();
+    if (stack.depth < ArenaTraceRecorder::max_label_depth) {
+        stack.labels[stack.depth] = label;
+    }
+    stack.depth++;
+}
+
+inline ArenaTraceLabel::~ArenaTraceLabel()
+{
+    ArenaTraceRecorder::LabelStack& stack = ArenaTraceRecorder::label_stack();
+    stack.depth--;
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "Arena.hpp"
+#include <memory>
+#include <thread>
+#include <vector>
+
+// K MemoryArenas used round-robin, one per generation, for pipelines that
+// fill batch N+1 while batch N is still being read. advance() moves
+// allocation to the next arena, resetting it first; that arena held the
+// generation K-1 steps back, so it is only recycled once every Pin on it has
+// been released. Nothing is freed per object and the current generation
+// keeps allocating while older ones drain.
+//
+// Every thread that touches a generation's memory, producer or consumer,
+// holds a Pin on it. Pins are taken on the current generation and copied or
+// moved along with the batch they belong to.
+class GenerationalArena {
+private:
+    struct Slot {
+        std::unique_ptr<MemoryArena> arena;
+        std::atomic<uint64_t> generation;  // recycling while advance() is deciding on it
+        std::atomic<size_t> readers{0};
+    };
+
+    static constexpr uint64_t recycling = UINT64_MAX;
+
+    std::vector<std::unique_ptr<Slot>> slots;
+    std::atomic<uint64_t> current_generation{0};
+    std::mutex advance_mutex;
+
+    Slot& slot_of(uint64_t generation) { return *slots[generation % slots.size()]; }
+public:
+    class Pin {
+    private:
+        Slot* slot = nullptr;
+        uint64_t pinned_generation = 0;
+
+        friend class GenerationalArena;
+        Pin(Slot* slot, uint64_t generation) : slot(slot), pinned_generation(generation) {}
+    public:
+        Pin() = default;
+        Pin(const Pin& other);
+        Pin(Pin&& other) noexcept;
+        Pin& operator=(Pin other) noexcept;
+        ~Pin() { release(); }
+
+        MemoryArena& arena() const { return *slot->arena; }
+        uint64_t generation() const { return pinned_generation; }
+        explicit operator bool() const { return slot != nullptr; }
+        void release();
+    };
+
+    // generations is clamped to at least 2
+    explicit GenerationalArena(size_t size_per_arena, size_t generations = 2,
+                               const ArenaOptions& options = ArenaOptions{});
+
+    GenerationalArena(const GenerationalArena&) = delete;
+    GenerationalArena& operator=(const GenerationalArena&) = delete;
+
+    Pin pin();
+    // Unpinned access to the current arena, for code that advances itself.
+    MemoryArena& current() { return *slot_of(current_generation.load(std::memory_order_acquire)).arena; }
+    uint64_t generation() const { return current_generation.load(std::memory_order_acquire); }
+    size_t generations() const { return slots.size(); }
+
+    bool try_advance();
+    void advance();
+};
+
+inline GenerationalArena::GenerationalArena(size_t size_per_arena, size_t generations, const ArenaOptions& options)
+{
+    if (generations < 2) {
+        generations = 2;
+    }
+    slots.reserve(generations);
+    for (size_t i = 0; i < generations; ++i) {
+        std::unique_ptr<Slot> slot(new Slot);
+        slot->arena.reset(new MemoryArena(size_per_arena, options));
+        slot->generation.store(i == 0 ? 0 : recycling, std::memory_order_relaxed);
+        slots.push_back(std::move(slot));
+    }
+}
+
+// The reader count goes up before the slot's generation is checked, while
+// try_advance() marks the slot before checking the count; with both sides
+// sequentially consistent at least one of them sees the other and backs off.
+inline GenerationalArena::Pin GenerationalArena::pin()
+{
+    for (;;) {
+        uint64_t generation = current_generation.load(std::memory_order_acquire);
+        Slot& slot = slot_of(generation);
+        slot.readers.fetch_add(1, std::memory_order_seq_cst);
+        if (slot.generation.load(std::memory_order_seq_cst) == generation &&
+            current_generation.load(std::memory_order_acquire) == generation) {
+            return Pin(&slot, generation);
+        }
+        slot.readers.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+// Returns false, changing nothing, while the arena to recycle is still pinned.
+inline bool GenerationalArena::try_advance()
+{
+    std::lock_guard<std::mutex> lock(advance_mutex);
+    uint64_t next = current_generation.load(std::memory_order_relaxed) + 1;
+    Slot& slot = slot_of(next);
+
+    uint64_t previous = slot.generation.exchange(recycling, std::memory_order_seq_cst);
+    if (slot.readers.load(std::memory_order_seq_cst) != 0) {
+        slot.generation.store(previous, std::memory_order_seq_cst);
+        return false;
+    }
+    slot.arena->reset();
+    slot.generation.store(next, std::memory_order_seq_cst);
+    current_generation.store(next, std::memory_order_release);
+    return true;
+}
+
+// Waits for the oldest generation's pins to be released.
+inline void GenerationalArena::advance()
+{
+    while (!try_advance()) {
+        std::this_thread::yield();
+    }
+}
+
+inline GenerationalArena::Pin::Pin(const Pin& other)
+    : slot(other.slot), pinned_generation(other.pinned_generation)
+{
+    if (slot) {
+        slot->readers.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+inline GenerationalArena::Pin::Pin(Pin&& other) noexcept
+    : slot(other.slot), pinned_generation(other.pinned_generation)
+{
+    other.slot = nullptr;
+}
+
+inline GenerationalArena::Pin& GenerationalArena::Pin::operator=(Pin other) noexcept
+{
+    std::swap(slot, other.slot);
+    std::swap(pinned_generation, other.pinned_generation);
+    return *this;
+}
+
+// Memory of the generation must not be touched after this.
+inline void GenerationalArena::Pin::release()
+{
+    if (slot) {
+        slot->readers.fetch_sub(1, std::memory_order_release);
+        slot = nullptr;
+    }
+}
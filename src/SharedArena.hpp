@@ -0,0 +1,326 @@
+#pragma once
+
+#include "Arena.hpp"
+#include <memory>
+
+#if ARENA_HAS_MMAP
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+// Bump arena over a shared-memory segment that several processes map at
+// once. All arena state lives in a header at the start of the segment, so
+// every attached process allocates with the same lock-free CAS bump and sees
+// the same cursor; there is no process-local bookkeeping to keep in sync.
+//
+// The segment maps at a different address in each process, so structures in
+// it must link by offset: offset_of() / at() convert, and arena_offset_ptr
+// from ArenaSnapshot.hpp works unchanged since it is self-relative. Objects
+// must be trivially destructible and free of process-local pointers; nothing
+// is ever finalized. Data starts on a page boundary, so an alignment up to the
+// page size means the same thing in every process; allocate_bytes() returns
+// nullptr for larger ones, which a mapping elsewhere would not honour.
+//
+// Segments are named POSIX shared memory (create/open/unlink) or, on Linux,
+// anonymous memfds (create_anonymous/open_fd) whose descriptor is inherited
+// by fork() or passed over a Unix socket.
+class SharedArena {
+private:
+    struct Header {
+        uint64_t magic;
+        uint32_t version;
+        std::atomic<uint32_t> ready;        // set once the creator has written the header
+        uint64_t total_size;                // bytes in the segment, header included
+        uint64_t data_offset;               // first allocatable offset, page aligned
+        std::atomic<uint64_t> cursor;       // offset of the next free byte
+        std::atomic<uint64_t> generation;   // bumped by reset()
+        std::atomic<uint64_t> root_offset;  // 0 when unset
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free,
+                  "SharedArena needs address-free 64-bit atomics");
+
+    static constexpr uint64_t magic = 0x4152454E41534852ull;  // "ARENASHR"
+    static constexpr uint32_t version = 1;
+
+    char* segment;
+    size_t segment_size;
+    int segment_fd;
+    Header* header;
+
+    SharedArena(char* segment, size_t size, int fd);
+
+    static std::unique_ptr<SharedArena> initialize(int fd, size_t size);
+    static std::unique_ptr<SharedArena> attach(int fd);
+public:
+    // Return nullptr if the segment cannot be created, opened or mapped, or,
+    // when attaching, does not hold an initialized arena.
+    static std::unique_ptr<SharedArena> create(const char* name, size_t size);
+    static std::unique_ptr<SharedArena> open(const char* name);
+    static bool unlink(const char* name);
+    static std::unique_ptr<SharedArena> create_anonymous(size_t size);
+    // Attaches to a descriptor from create_anonymous() or fd(); takes a
+    // duplicate, the caller keeps its own descriptor.
+    static std::unique_ptr<SharedArena> open_fd(int fd);
+
+    ~SharedArena();
+
+    SharedArena(const SharedArena&) = delete;
+    SharedArena& operator=(const SharedArena&) = delete;
+
+    void* allocate_bytes(size_t size, size_t alignment = alignof(std::max_align_t));
+    template<typename T>
+    T* allocate();
+    template<typename T>
+    T* allocate_array(size_t count);
+
+    uint64_t offset_of(const void* ptr) const { return static_cast<uint64_t>(static_cast<const char*>(ptr) - segment); }
+    template<typename T>
+    T* at(uint64_t offset) const { return reinterpret_cast<T*>(segment + offset); }
+    bool contains(const void* ptr) const;
+
+    // Publishes an entry point for other processes; 0 clears it.
+    void set_root(const void* ptr);
+    template<typename T>
+    T* root() const;
+
+    // Must not race with any attached process still using the memory.
+    void reset();
+    size_t remaining() const;
+    size_t capacity() const { return static_cast<size_t>(header->total_size - header->data_offset); }
+    uint64_t generation() const { return header->generation.load(std::memory_order_acquire); }
+    int fd() const { return segment_fd; }
+};
+
+inline SharedArena::SharedArena(char* segment, size_t size, int fd)
+    : segment(segment),
+      segment_size(size),
+      segment_fd(fd),
+      header(reinterpret_cast<Header*>(segment))
+{
+}
+
+inline SharedArena::~SharedArena()
+{
+#if ARENA_HAS_MMAP
+    munmap(segment, segment_size);
+    close(segment_fd);
+#endif
+}
+
+// Sizes the segment, maps it and writes the header. Takes ownership of fd.
+inline std::unique_ptr<SharedArena> SharedArena::initialize(int fd, size_t size)
+{
+#if ARENA_HAS_MMAP
+    size_t page = MemoryArena::page_size();
+    size_t data_offset = (sizeof(Header) + page - 1) & ~(page - 1);
+    if (size > SIZE_MAX - data_offset - page) {
+        close(fd);
+        return nullptr;
+    }
+    size_t total = (data_offset + size + page - 1) & ~(page - 1);
+    if (ftruncate(fd, static_cast<off_t>(total)) != 0) {
+        close(fd);
+        return nullptr;
+    }
+    void* mapping = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        close(fd);
+        return nullptr;
+    }
+
+    Header* header = new (mapping) Header;
+    header->magic = magic;
+    header->version = version;
+    header->total_size = total;
+    header->data_offset = data_offset;
+    header->cursor.store(data_offset, std::memory_order_relaxed);
+    header->generation.store(0, std::memory_order_relaxed);
+    header->root_offset.store(0, std::memory_order_relaxed);
+    header->ready.store(1, std::memory_order_release);
+    return std::unique_ptr<SharedArena>(new SharedArena(static_cast<char*>(mapping), total, fd));
+#else
+    (void)fd;
+    (void)size;
+    return nullptr;
+#endif
+}
+
+// Maps an existing segment after checking its header. Takes ownership of fd.
+inline std::unique_ptr<SharedArena> SharedArena::attach(int fd)
+{
+#if ARENA_HAS_MMAP
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<uint64_t>(info.st_size) < sizeof(Header)) {
+        close(fd);
+        return nullptr;
+    }
+    size_t total = static_cast<size_t>(info.st_size);
+    void* mapping = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        close(fd);
+        return nullptr;
+    }
+    Header* header = static_cast<Header*>(mapping);
+    if (!header->ready.load(std::memory_order_acquire) || header->magic != magic ||
+        header->version != version || header->total_size != total || header->data_offset >= total) {
+        munmap(mapping, total);
+        close(fd);
+        return nullptr;
+    }
+    return std::unique_ptr<SharedArena>(new SharedArena(static_cast<char*>(mapping), total, fd));
+#else
+    (void)fd;
+    return nullptr;
+#endif
+}
+
+// Fails if a segment of that name already exists; unlink() it first to
+// start over. name follows shm_open rules, e.g. "/my-tables".
+inline std::unique_ptr<SharedArena> SharedArena::create(const char* name, size_t size)
+{
+#if ARENA_HAS_MMAP
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        return nullptr;
+    }
+    std::unique_ptr<SharedArena> arena = initialize(fd, size);
+    if (!arena) {
+        shm_unlink(name);
+    }
+    return arena;
+#else
+    (void)name;
+    (void)size;
+    return nullptr;
+#endif
+}
+
+inline std::unique_ptr<SharedArena> SharedArena::open(const char* name)
+{
+#if ARENA_HAS_MMAP
+    int fd = shm_open(name, O_RDWR, 0600);
+    if (fd < 0) {
+        return nullptr;
+    }
+    return attach(fd);
+#else
+    (void)name;
+    return nullptr;
+#endif
+}
+
+// Removes the name; processes that are attached keep their mapping.
+inline bool SharedArena::unlink(const char* name)
+{
+#if ARENA_HAS_MMAP
+    return shm_unlink(name) == 0;
+#else
+    (void)name;
+    return false;
+#endif
+}
+
+inline std::unique_ptr<SharedArena> SharedArena::create_anonymous(size_t size)
+{
+#if ARENA_HAS_MMAP && defined(__linux__) && defined(MFD_CLOEXEC)
+    int fd = memfd_create("arena", 0);
+    if (fd < 0) {
+        return nullptr;
+    }
+    return initialize(fd, size);
+#else
+    (void)size;
+    return nullptr;
+#endif
+}
+
+inline std::unique_ptr<SharedArena> SharedArena::open_fd(int fd)
+{
+#if ARENA_HAS_MMAP
+    int own = dup(fd);
+    if (own < 0) {
+        return nullptr;
+    }
+    return attach(own);
+#else
+    (void)fd;
+    return nullptr;
+#endif
+}
+
+// Same CAS bump as MemoryArena's lock-free mode, on an offset instead of a
+// pointer so every process agrees on it.
+inline void* SharedArena::allocate_bytes(size_t size, size_t alignment)
+{
+    if (size == 0) return nullptr;
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) return nullptr;
+    if (alignment > MemoryArena::page_size()) return nullptr;
+
+    const uint64_t end = header->total_size;
+    uint64_t current = header->cursor.load(std::memory_order_relaxed);
+    uint64_t aligned;
+    do {
+        aligned = (current + alignment - 1) & ~(static_cast<uint64_t>(alignment) - 1);
+        if (aligned > end || size > end - aligned) {
+            return nullptr;
+        }
+    } while (!header->cursor.compare_exchange_weak(current, aligned + size, std::memory_order_relaxed));
+    return segment + aligned;
+}
+
+template<typename T>
+T* SharedArena::allocate()
+{
+    static_assert(std::is_trivially_destructible_v<T>, "SharedArena never runs destructors");
+    void* ptr = allocate_bytes(sizeof(T), alignof(T));
+    return ptr ? new (ptr) T() : nullptr;
+}
+
+template<typename T>
+T* SharedArena::allocate_array(size_t count)
+{
+    static_assert(std::is_trivially_destructible_v<T>, "SharedArena never runs destructors");
+    if (count == 0) return nullptr;
+    if (count > SIZE_MAX / sizeof(T)) return nullptr;
+    T* array_start = static_cast<T*>(allocate_bytes(count * sizeof(T), alignof(T)));
+    if (array_start) {
+        for (size_t i = 0; i < count; ++i) {
+            new (array_start + i) T();
+        }
+    }
+    return array_start;
+}
+
+inline bool SharedArena::contains(const void* ptr) const
+{
+    const char* p = static_cast<const char*>(ptr);
+    return p >= segment + header->data_offset && p < segment + header->total_size;
+}
+
+// Release pairs with the acquire in root(), so a reader that sees the root
+// also sees everything written before it was published.
+inline void SharedArena::set_root(const void* ptr)
+{
+    header->root_offset.store(ptr ? offset_of(ptr) : 0, std::memory_order_release);
+}
+
+template<typename T>
+T* SharedArena::root() const
+{
+    uint64_t offset = header->root_offset.load(std::memory_order_acquire);
+    return offset ? at<T>(offset) : nullptr;
+}
+
+inline void SharedArena::reset()
+{
+    header->root_offset.store(0, std::memory_order_relaxed);
+    header->cursor.store(header->data_offset, std::memory_order_release);
+    header->generation.fetch_add(1, std::memory_order_release);
+}
+
+inline size_t SharedArena::remaining() const
+{
+    uint64_t cursor = header->cursor.load(std::memory_order_acquire);
+    return static_cast<size_t>(header->total_size - cursor);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Arena.hpp"
+
+template<size_t N>
+struct StaticArenaBuffer {
+    alignas(std::max_align_t) char inline_buffer[N];
+};
+
+// Arena whose first N bytes live inside the object itself, on the stack or in
+// an owning struct, like monotonic_buffer_resource with an initial buffer.
+// Nothing touches the heap until the inline bytes run out; then blocks are
+// chained per options (Geometric by default) and reset() returns to the
+// inline buffer. The block header takes a few dozen of the N bytes.
+//
+// The buffer is a base declared before the arena so that it outlives the
+// finalizers the arena runs on destruction.
+template<size_t N, typename LockPolicy = MutexLock,
+         typename StatsPolicy = ArenaStatsCounters<ARENA_ENABLE_STATS != 0>>
+class StaticArena : private StaticArenaBuffer<N>, public BasicArena<LockPolicy, StatsPolicy> {
+public:
+    static_assert(N >= 256, "StaticArena needs room for its block header");
+
+    static constexpr size_t inline_capacity = N;
+
+    explicit StaticArena(const ArenaOptions& options = default_options())
+        : BasicArena<LockPolicy, StatsPolicy>(this->inline_buffer, N, options)
+    {
+    }
+
+    // True if ptr points into the inline buffer.
+    bool is_inline(const void* ptr) const {
+        const char* p = static_cast<const char*>(ptr);
+        return p >= this->inline_buffer && p < this->inline_buffer + N;
+    }
+
+    static ArenaOptions default_options() {
+        ArenaOptions options;
+        options.growth = GrowthPolicy::Geometric;
+        return options;
+    }
+};
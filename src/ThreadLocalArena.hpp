@@ -0,0 +1,142 @@
+#pragma once
+
+#include "Arena.hpp"
+
+// Single-threaded front-end over a shared MemoryArena. Each worker thread owns
+// its own ThreadLocalArena; allocations are served from a private chunk with a
+// plain pointer bump and only refills touch the parent. A reset() of the parent
+// bumps its generation, which makes every front-end drop its chunk on the next
+// allocation instead of handing out memory the parent has already reclaimed.
+// Objects are not registered with the parent's destructor registry, so only
+// trivially destructible types should outlive the front-end's own bookkeeping.
+class ThreadLocalArena {
+private:
+    MemoryArena& parent;
+    const size_t chunk_size;
+    char* chunk_ptr;
+    char* chunk_end;
+    uint64_t chunk_generation;
+
+    char* bump(size_t size, size_t alignment);
+    bool refill(size_t size, size_t alignment);
+public:
+    static constexpr size_t default_chunk_size = 64 * 1024;
+
+    explicit ThreadLocalArena(MemoryArena& parent, size_t chunk_size = default_chunk_size);
+
+    ThreadLocalArena(const ThreadLocalArena&) = delete;
+    ThreadLocalArena& operator=(const ThreadLocalArena&) = delete;
+
+    template<typename T>
+    ARENA_HOOKED_ENTRY T* allocate();
+    template<typename T>
+    ARENA_HOOKED_ENTRY T* allocate_array(size_t count);
+
+    void release();
+    size_t remaining() const;
+};
+
+inline ThreadLocalArena::ThreadLocalArena(MemoryArena& parent, size_t chunk_size)
+    : parent(parent),
+      chunk_size(chunk_size),
+      chunk_ptr(nullptr),
+      chunk_end(nullptr),
+      chunk_generation(0)
+{
+}
+
+// Forgets the current chunk. The memory stays in the parent until its reset().
+inline void ThreadLocalArena::release()
+{
+    chunk_ptr = nullptr;
+    chunk_end = nullptr;
+}
+
+inline size_t ThreadLocalArena::remaining() const
+{
+    if (chunk_generation != parent.generation.load(std::memory_order_acquire)) {
+        return 0;
+    }
+    return chunk_end - chunk_ptr;
+}
+
+// Grabs a fresh chunk from the parent. Requests larger than a chunk get a
+// dedicated chunk of their own size; if the parent cannot fit a full chunk the
+// tail of it is still used for this request. The chunk raises no hook event;
+// allocate() and allocate_array() report each request instead.
+inline bool ThreadLocalArena::refill(size_t size, size_t alignment)
+{
+    size_t wanted = size + alignment - 1;
+    if (wanted < size) {
+        return false;
+    }
+    if (wanted < chunk_size) {
+        wanted = chunk_size;
+    }
+
+    uint64_t current_generation = parent.generation.load(std::memory_order_acquire);
+    char* chunk = parent.bump(wanted, alignof(std::max_align_t));
+    if (!chunk && wanted > size + alignment - 1) {
+        wanted = size + alignment - 1;
+        chunk = parent.bump(wanted, alignof(std::max_align_t));
+    }
+    if (!chunk) {
+        return false;
+    }
+
+    chunk_ptr = chunk;
+    chunk_end = chunk + wanted;
+    chunk_generation = current_generation;
+    return true;
+}
+
+inline char* ThreadLocalArena::bump(size_t size, size_t alignment)
+{
+    if (chunk_generation != parent.generation.load(std::memory_order_relaxed)) {
+        release();
+    }
+
+    uintptr_t addr = reinterpret_cast<uintptr_t>(chunk_ptr);
+    uintptr_t aligned = (addr + alignment - 1) & ~(alignment - 1);
+    uintptr_t end = reinterpret_cast<uintptr_t>(chunk_end);
+    if (!chunk_ptr || aligned > end || size > end - aligned) {
+        if (!refill(size, alignment)) {
+            return nullptr;
+        }
+        addr = reinterpret_cast<uintptr_t>(chunk_ptr);
+        aligned = (addr + alignment - 1) & ~(alignment - 1);
+    }
+
+    chunk_ptr = reinterpret_cast<char*>(aligned + size);
+    return reinterpret_cast<char*>(aligned);
+}
+
+template<typename T>
+T* ThreadLocalArena::allocate()
+{
+    char* aligned_ptr = bump(sizeof(T), alignof(T));
+    parent.notify_allocation(aligned_ptr, sizeof(T), alignof(T), ARENA_CALL_SITE());
+    if (!aligned_ptr) {
+        return nullptr;
+    }
+    return new(aligned_ptr) T();
+}
+
+template<typename T>
+T* ThreadLocalArena::allocate_array(size_t count)
+{
+    if (count == 0) return nullptr;
+    if (count > SIZE_MAX / sizeof(T)) return nullptr;
+
+    char* aligned_ptr = bump(count * sizeof(T), alignof(T));
+    parent.notify_allocation(aligned_ptr, count * sizeof(T), alignof(T), ARENA_CALL_SITE());
+    if (!aligned_ptr) {
+        return nullptr;
+    }
+
+    T* array_start = reinterpret_cast<T*>(aligned_ptr);
+    for (size_t i = 0; i < count; ++i) {
+        new(array_start + i) T();
+    }
+    return array_start;
+}
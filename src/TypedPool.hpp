@@ -0,0 +1,148 @@
+#pragma once
+
+#include "Arena.hpp"
+#include <utility>
+
+// Fixed-size object pool on top of a MemoryArena. Slots are carved out of
+// slabs of slab_count objects and freed slots go onto an intrusive free list,
+// so allocate/deallocate are O(1) in any order and objects of one type stay
+// packed together. Slots are not registered with the arena's destructor
+// registry: objects still alive when the arena is reset are abandoned, and the
+// pool starts over with fresh slabs on its next allocation.
+template<typename T>
+class TypedPool {
+private:
+    union Slot {
+        Slot* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    MemoryArena& arena;
+    const size_t slab_count;
+    Slot* free_list;
+    Slot* slab_cursor;
+    Slot* slab_end;
+    size_t slot_capacity;
+    size_t live_count;
+    uint64_t arena_generation;
+    mutable std::mutex pool_mutex;
+
+    Slot* take_slot();
+public:
+    static constexpr size_t default_slab_count = 64;
+
+    explicit TypedPool(MemoryArena& arena, size_t slab_count = default_slab_count);
+
+    TypedPool(const TypedPool&) = delete;
+    TypedPool& operator=(const TypedPool&) = delete;
+
+    template<typename... Args>
+    ARENA_HOOKED_ENTRY T* allocate(Args&&... args);
+    void deallocate(T* object);
+
+    size_t capacity() const;
+    size_t size() const;
+};
+
+template<typename T>
+TypedPool<T>::TypedPool(MemoryArena& arena, size_t slab_count)
+    : arena(arena),
+      slab_count(slab_count ? slab_count : 1),
+      free_list(nullptr),
+      slab_cursor(nullptr),
+      slab_end(nullptr),
+      slot_capacity(0),
+      live_count(0),
+      arena_generation(arena.generation.load(std::memory_order_acquire))
+{
+}
+
+// Called with pool_mutex held. Pops the free list first, then carves the
+// current slab, then asks the arena for a new slab. allocate() reports the
+// slot to the arena's hooks; the slab itself raises no event.
+template<typename T>
+typename TypedPool<T>::Slot* TypedPool<T>::take_slot()
+{
+    uint64_t current_generation = arena.generation.load(std::memory_order_acquire);
+    if (current_generation != arena_generation) {
+        free_list = nullptr;
+        slab_cursor = nullptr;
+        slab_end = nullptr;
+        slot_capacity = 0;
+        live_count = 0;
+        arena_generation = current_generation;
+    }
+
+    if (free_list) {
+        Slot* slot = free_list;
+        free_list = slot->next;
+        return slot;
+    }
+    if (slab_cursor == slab_end) {
+        char* slab = arena.bump(slab_count * sizeof(Slot), alignof(Slot));
+        if (!slab) {
+            return nullptr;
+        }
+        slab_cursor = reinterpret_cast<Slot*>(slab);
+        slab_end = slab_cursor + slab_count;
+        slot_capacity += slab_count;
+    }
+    return slab_cursor++;
+}
+
+template<typename T>
+template<typename... Args>
+T* TypedPool<T>::allocate(Args&&... args)
+{
+    Slot* slot;
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        slot = take_slot();
+        if (slot) {
+            live_count++;
+        }
+    }
+    arena.notify_allocation(slot, sizeof(T), alignof(T), ARENA_CALL_SITE());
+    if (!slot) {
+        return nullptr;
+    }
+    try {
+        return new(slot->storage) T(std::forward<Args>(args)...);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        slot->next = free_list;
+        free_list = slot;
+        live_count--;
+        throw;
+    }
+}
+
+template<typename T>
+void TypedPool<T>::deallocate(T* object)
+{
+    if (!object) return;
+    object->~T();
+
+    Slot* slot = reinterpret_cast<Slot*>(object);
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    if (arena.generation.load(std::memory_order_acquire) != arena_generation) {
+        return;
+    }
+    slot->next = free_list;
+    free_list = slot;
+    live_count--;
+}
+
+template<typename T>
+size_t TypedPool<T>::capacity() const
+{
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    return slot_capacity;
+}
+
+template<typename T>
+size_t TypedPool<T>::size() const
+{
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    return live_count;
+}
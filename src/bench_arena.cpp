@@ -0,0 +1,389 @@
+#include "Arena.hpp"
+#include "ThreadLocalArena.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory_resource>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(ARENA_BENCH_JEMALLOC) && __has_include(<jemalloc/jemalloc.h>)
+#include <jemalloc/jemalloc.h>
+#define ARENA_BENCH_HAS_JEMALLOC 1
+#endif
+#if defined(ARENA_BENCH_MIMALLOC) && __has_include(<mimalloc.h>)
+#include <mimalloc.h>
+#define ARENA_BENCH_HAS_MIMALLOC 1
+#endif
+
+// Allocation microbenchmarks comparing MemoryArena with the usual
+// alternatives. Every allocator is driven through the same small adapter
+// interface so each one pays for the same loop:
+//
+//   alloc(size, align)  one allocation, timed in small batches
+//   release_all()       frees / resets everything, timed separately
+//
+// Build with -O2. Pass --quick for a short run. jemalloc and mimalloc are
+// included when built with -DARENA_BENCH_JEMALLOC / -DARENA_BENCH_MIMALLOC
+// and linked against the library.
+
+using bench_clock = std::chrono::steady_clock;
+
+static size_t quick_divisor = 1;
+
+static void do_not_optimize(void* ptr)
+{
+    asm volatile("" : : "g"(ptr) : "memory");
+}
+
+struct ArenaAdapter {
+    MemoryArena arena;
+    ArenaAdapter(size_t capacity, ArenaFlags flags) : arena(capacity, flags) {}
+    void* alloc(size_t size, size_t align) { return arena.allocate_bytes(size, align); }
+    void release_all() { arena.reset(); }
+};
+
+struct NewDeleteAdapter {
+    std::vector<char*> live;
+    void* alloc(size_t size, size_t) {
+        char* ptr = new char[size];
+        live.push_back(ptr);
+        return ptr;
+    }
+    void release_all() {
+        for (char* ptr : live) delete[] ptr;
+        live.clear();
+    }
+};
+
+struct MallocAdapter {
+    std::vector<void*> live;
+    void* alloc(size_t size, size_t) {
+        void* ptr = std::malloc(size);
+        live.push_back(ptr);
+        return ptr;
+    }
+    void release_all() {
+        for (void* ptr : live) std::free(ptr);
+        live.clear();
+    }
+};
+
+struct MonotonicAdapter {
+    std::pmr::monotonic_buffer_resource resource;
+    explicit MonotonicAdapter(size_t capacity) : resource(capacity) {}
+    void* alloc(size_t size, size_t align) { return resource.allocate(size, align); }
+    void release_all() { resource.release(); }
+};
+
+#ifdef ARENA_BENCH_HAS_JEMALLOC
+struct JemallocAdapter {
+    std::vector<void*> live;
+    void* alloc(size_t size, size_t) {
+        void* ptr = mallocx(size, 0);
+        live.push_back(ptr);
+        return ptr;
+    }
+    void release_all() {
+        for (void* ptr : live) dallocx(ptr, 0);
+        live.clear();
+    }
+};
+#endif
+
+#ifdef ARENA_BENCH_HAS_MIMALLOC
+struct MimallocAdapter {
+    std::vector<void*> live;
+    void* alloc(size_t size, size_t) {
+        void* ptr = mi_malloc(size);
+        live.push_back(ptr);
+        return ptr;
+    }
+    void release_all() {
+        for (void* ptr : live) mi_free(ptr);
+        live.clear();
+    }
+};
+#endif
+
+struct LatencyResult {
+    double p50_ns;
+    double p99_ns;
+    double mops;
+};
+
+// Times allocations in small batches so the clock itself does not dominate
+// the sample, and reports percentiles of the per-allocation batch average.
+// Samples are collected over several rounds with a release_all() in between so
+// the allocator never runs dry.
+template<typename Adapter>
+static LatencyResult measure_latency(Adapter& adapter, size_t size, size_t ops_per_round, size_t rounds)
+{
+    const size_t batch = ops_per_round >= 256 ? 16 : 1;
+    std::vector<double> samples;
+    samples.reserve(ops_per_round / batch * rounds);
+    double total_ns = 0.0;
+    size_t total_ops = 0;
+
+    for (size_t round = 0; round < rounds; ++round) {
+        for (size_t i = 0; i + batch <= ops_per_round; i += batch) {
+            auto start = bench_clock::now();
+            for (size_t j = 0; j < batch; ++j) {
+                do_not_optimize(adapter.alloc(size, alignof(std::max_align_t)));
+            }
+            auto end = bench_clock::now();
+            double ns = std::chrono::duration<double, std::nano>(end - start).count();
+            samples.push_back(ns / batch);
+            total_ns += ns;
+            total_ops += batch;
+        }
+        adapter.release_all();
+    }
+
+    std::sort(samples.begin(), samples.end());
+    LatencyResult result;
+    result.p50_ns = samples[samples.size() / 2];
+    result.p99_ns = samples[std::min(samples.size() - 1, samples.size() * 99 / 100)];
+    result.mops = total_ns > 0.0 ? total_ops / (total_ns / 1000.0) : 0.0;
+    return result;
+}
+
+static void print_header(const char* title)
+{
+    std::printf("\n%s\n", title);
+    std::printf("%-48s %12s %12s %12s\n", "Benchmark", "p50 (ns)", "p99 (ns)", "Mops/s");
+    std::printf("%s\n", std::string(87, '-').c_str());
+}
+
+static void print_latency(const std::string& name, const LatencyResult& result)
+{
+    std::printf("%-48s %12.1f %12.1f %12.2f\n", name.c_str(), result.p50_ns, result.p99_ns, result.mops);
+}
+
+// Keeps per-round memory bounded: 64 MiB for small sizes, at least 16 ops.
+static size_t ops_for_size(size_t size)
+{
+    size_t ops = (size_t(64) << 20) / size / quick_divisor;
+    return std::max<size_t>(16, std::min<size_t>(ops, 20000 / quick_divisor));
+}
+
+static void bench_latency_by_size()
+{
+    print_header("Allocation latency by size");
+    const size_t sizes[] = {8, 64, 512, 4096, 64 * 1024, 1024 * 1024};
+    const size_t rounds = 5;
+
+    for (size_t size : sizes) {
+        size_t ops = ops_for_size(size);
+        size_t capacity = ops * (size + alignof(std::max_align_t));
+        std::string suffix = "/" + std::to_string(size);
+
+        {
+            ArenaAdapter adapter(capacity, ArenaFlags::None);
+            print_latency("MemoryArena" + suffix, measure_latency(adapter, size, ops, rounds));
+        }
+        {
+            ArenaAdapter adapter(capacity, ArenaFlags::LockFree);
+            print_latency("MemoryArena<LockFree>" + suffix, measure_latency(adapter, size, ops, rounds));
+        }
+        {
+            MonotonicAdapter adapter(capacity);
+            print_latency("pmr::monotonic_buffer_resource" + suffix, measure_latency(adapter, size, ops, rounds));
+        }
+        {
+            NewDeleteAdapter adapter;
+            adapter.live.reserve(ops);
+            print_latency("new[]" + suffix, measure_latency(adapter, size, ops, rounds));
+        }
+        {
+            MallocAdapter adapter;
+            adapter.live.reserve(ops);
+            print_latency("malloc" + suffix, measure_latency(adapter, size, ops, rounds));
+        }
+#ifdef ARENA_BENCH_HAS_JEMALLOC
+        {
+            JemallocAdapter adapter;
+            adapter.live.reserve(ops);
+            print_latency("jemalloc" + suffix, measure_latency(adapter, size, ops, rounds));
+        }
+#endif
+#ifdef ARENA_BENCH_HAS_MIMALLOC
+        {
+            MimallocAdapter adapter;
+            adapter.live.reserve(ops);
+            print_latency("mimalloc" + suffix, measure_latency(adapter, size, ops, rounds));
+        }
+#endif
+    }
+}
+
+// Runs worker(thread_index) on every thread after a common start signal and
+// returns the aggregate rate in millions of allocations per second.
+template<typename Worker>
+static double run_threads(int num_threads, size_t ops_per_thread, Worker worker)
+{
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t]() {
+            while (!go.load()) {
+                std::this_thread::yield();
+            }
+            worker(t);
+        });
+    }
+    auto start = bench_clock::now();
+    go = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double us = std::chrono::duration<double, std::micro>(bench_clock::now() - start).count();
+    return us > 0.0 ? num_threads * ops_per_thread / us : 0.0;
+}
+
+static void bench_throughput_by_threads()
+{
+    std::printf("\nThroughput by thread count (64 B allocations)\n");
+    std::printf("%-48s %12s\n", "Benchmark", "Mops/s");
+    std::printf("%s\n", std::string(61, '-').c_str());
+
+    const size_t size = 64;
+    const size_t ops_per_thread = 100000 / quick_divisor;
+    const int thread_counts[] = {1, 2, 4, 8, 16, 32};
+
+    for (int num_threads : thread_counts) {
+        size_t capacity = num_threads * ops_per_thread * size + (size_t(1) << 20);
+        std::string suffix = "/threads:" + std::to_string(num_threads);
+
+        {
+            MemoryArena arena(capacity);
+            double mops = run_threads(num_threads, ops_per_thread, [&](int) {
+                for (size_t i = 0; i < ops_per_thread; ++i) {
+                    do_not_optimize(arena.allocate_array_uninit<char>(size));
+                }
+            });
+            std::printf("%-48s %12.2f\n", ("MemoryArena" + suffix).c_str(), mops);
+        }
+        {
+            MemoryArena arena(capacity, ArenaFlags::LockFree);
+            double mops = run_threads(num_threads, ops_per_thread, [&](int) {
+                for (size_t i = 0; i < ops_per_thread; ++i) {
+                    do_not_optimize(arena.allocate_array_uninit<char>(size));
+                }
+            });
+            std::printf("%-48s %12.2f\n", ("MemoryArena<LockFree>" + suffix).c_str(), mops);
+        }
+        {
+            MemoryArena arena(capacity + num_threads * ThreadLocalArena::default_chunk_size, ArenaFlags::LockFree);
+            double mops = run_threads(num_threads, ops_per_thread, [&](int) {
+                ThreadLocalArena local(arena);
+                for (size_t i = 0; i < ops_per_thread; ++i) {
+                    do_not_optimize(local.allocate_array<char>(size));
+                }
+            });
+            std::printf("%-48s %12.2f\n", ("ThreadLocalArena" + suffix).c_str(), mops);
+        }
+        {
+            std::vector<std::vector<void*>> live(num_threads);
+            double mops = run_threads(num_threads, ops_per_thread, [&](int t) {
+                live[t].reserve(ops_per_thread);
+                for (size_t i = 0; i < ops_per_thread; ++i) {
+                    live[t].push_back(std::malloc(size));
+                }
+            });
+            for (auto& ptrs : live) {
+                for (void* ptr : ptrs) std::free(ptr);
+            }
+            std::printf("%-48s %12.2f\n", ("malloc" + suffix).c_str(), mops);
+        }
+    }
+}
+
+struct NonTrivial {
+    int value = 1;
+    ~NonTrivial() { do_not_optimize(&value); }
+};
+
+static void bench_reset_cost()
+{
+    std::printf("\nReset cost\n");
+    std::printf("%-48s %12s\n", "Benchmark", "ns/reset");
+    std::printf("%s\n", std::string(61, '-').c_str());
+
+    const size_t allocations[] = {0, 1000, 100000};
+    const size_t repeats = 20;
+
+    for (size_t count : allocations) {
+        std::string suffix = "/allocs:" + std::to_string(count);
+
+        MemoryArena arena(count * 64 + 4096);
+        double total = 0.0;
+        for (size_t r = 0; r < repeats; ++r) {
+            for (size_t i = 0; i < count; ++i) {
+                do_not_optimize(arena.allocate<int>());
+            }
+            auto start = bench_clock::now();
+            arena.reset();
+            total += std::chrono::duration<double, std::nano>(bench_clock::now() - start).count();
+        }
+        std::printf("%-48s %12.1f\n", ("MemoryArena::reset/trivial" + suffix).c_str(), total / repeats);
+
+        total = 0.0;
+        for (size_t r = 0; r < repeats; ++r) {
+            for (size_t i = 0; i < count; ++i) {
+                do_not_optimize(arena.allocate<NonTrivial>());
+            }
+            auto start = bench_clock::now();
+            arena.reset();
+            total += std::chrono::duration<double, std::nano>(bench_clock::now() - start).count();
+        }
+        std::printf("%-48s %12.1f\n", ("MemoryArena::reset/destructors" + suffix).c_str(), total / repeats);
+
+        ArenaOptions growing;
+        growing.growth = GrowthPolicy::Linear;
+        MemoryArena chained(4096, growing);
+        total = 0.0;
+        for (size_t r = 0; r < repeats; ++r) {
+            for (size_t i = 0; i < count; ++i) {
+                do_not_optimize(chained.allocate<int>());
+            }
+            auto start = bench_clock::now();
+            chained.reset();
+            total += std::chrono::duration<double, std::nano>(bench_clock::now() - start).count();
+        }
+        std::printf("%-48s %12.1f\n", ("MemoryArena::reset/chained" + suffix).c_str(), total / repeats);
+
+        std::pmr::monotonic_buffer_resource resource(4096);
+        total = 0.0;
+        for (size_t r = 0; r < repeats; ++r) {
+            for (size_t i = 0; i < count; ++i) {
+                do_not_optimize(resource.allocate(sizeof(int), alignof(int)));
+            }
+            auto start = bench_clock::now();
+            resource.release();
+            total += std::chrono::duration<double, std::nano>(bench_clock::now() - start).count();
+        }
+        std::printf("%-48s %12.1f\n", ("monotonic_buffer_resource::release" + suffix).c_str(), total / repeats);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--quick") == 0) {
+            quick_divisor = 10;
+        }
+    }
+
+    std::printf("=== Memory Arena Benchmarks ===\n");
+    std::printf("Hardware threads: %u\n", std::thread::hardware_concurrency());
+
+    bench_latency_by_size();
+    bench_throughput_by_threads();
+    bench_reset_cost();
+    return 0;
+}
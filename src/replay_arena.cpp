@@ -0,0 +1,468 @@
+#include "Arena.hpp"
+#include "ArenaTrace.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if __has_include(<sys/resource.h>) && __has_include(<sys/wait.h>)
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define ARENA_REPLAY_FORK 1
+#endif
+
+// Replays an allocation trace written by ArenaTraceRecorder::write_binary()
+// against a range of arena configurations, so designs can be compared on a
+// recorded production mix instead of a synthetic loop.
+//
+// Every recorded thread gets a replay thread and every recorded arena a fresh
+// arena. By default events run in exactly the recorded order: each thread
+// waits for the previous event to finish before it performs its own, which
+// keeps the interleaving but serializes the threads. --free-running lets the
+// threads race between resets instead, which exercises lock contention but
+// not the recorded order. Each configuration runs in a child process so its
+// peak RSS is its own.
+//
+//   replay_arena TRACE [--lock mutex|lockfree|null] [--backing heap|mmap]
+//                      [--growth fixed|linear|geometric] [--capacity BYTES]
+//                      [--block-size BYTES] [--free-running]
+//   replay_arena --synthesize TRACE [--threads N] [--events N]
+//
+// Without --lock / --backing / --growth every combination is run. The null
+// lock skips free-running mode since it is only safe when events do not
+// overlap. Build with -O2.
+//
+// A trace holds only what raised hook events: allocations, failures and
+// resets. Frees, rewind() and in-place growth are not recorded, so memory a
+// TypedPool or ArenaHeap recycled replays as fresh bumps and peak RSS is an
+// upper bound for such workloads.
+
+using replay_clock = std::chrono::steady_clock;
+using Record = ArenaTraceRecorder::Record;
+
+enum class LockChoice { Mutex, LockFree, Null };
+
+struct ReplayConfig {
+    LockChoice lock;
+    BackingPolicy backing;
+    GrowthPolicy growth;
+};
+
+struct ReplayResult {
+    uint64_t operations;
+    uint64_t failures;
+    double wall_ms;
+    double p50_ns;
+    double p99_ns;
+    double p999_ns;
+    double max_ns;
+    long peak_rss_kb;
+};
+
+struct ReplayEvent {
+    uint64_t index;   // position in the recorded order
+    uint32_t arena;
+    ArenaEvent kind;
+    size_t size;
+    size_t alignment;
+};
+
+struct Trace {
+    std::vector<std::vector<ReplayEvent>> threads;
+    uint32_t arena_count = 0;
+    uint64_t event_count = 0;
+    size_t peak_bytes = 0;  // largest sum of requests between two resets of any arena
+};
+
+static size_t capacity_override = 0;
+static size_t block_size = size_t(1) << 20;
+static bool free_running = false;
+
+static void do_not_optimize(void* ptr)
+{
+    asm volatile("" : : "g"(ptr) : "memory");
+}
+
+static bool load_trace(const char* path, Trace& trace)
+{
+    std::ifstream in(path, std::ios::binary);
+    std::vector<Record> records;
+    if (!in || !ArenaTraceRecorder::read_binary(in, records)) {
+        return false;
+    }
+
+    std::vector<uint32_t> thread_numbers;
+    std::vector<size_t> arena_bytes;
+    for (const Record& record : records) {
+        auto found = std::find(thread_numbers.begin(), thread_numbers.end(), record.thread);
+        size_t thread = static_cast<size_t>(found - thread_numbers.begin());
+        if (found == thread_numbers.end()) {
+            thread_numbers.push_back(record.thread);
+            trace.threads.emplace_back();
+        }
+        if (record.arena >= arena_bytes.size()) {
+            arena_bytes.resize(record.arena + 1, 0);
+        }
+        if (record.kind == ArenaEvent::Reset) {
+            arena_bytes[record.arena] = 0;
+        } else {
+            arena_bytes[record.arena] += record.size + record.alignment;
+            trace.peak_bytes = std::max(trace.peak_bytes, arena_bytes[record.arena]);
+        }
+        trace.threads[thread].push_back(ReplayEvent{trace.event_count++, record.arena, record.kind,
+                                                    static_cast<size_t>(record.size),
+                                                    static_cast<size_t>(record.alignment)});
+    }
+    trace.arena_count = static_cast<uint32_t>(arena_bytes.size());
+    return true;
+}
+
+// Per-op latencies of one thread, in nanoseconds.
+struct ThreadSamples {
+    std::vector<float> latencies;
+    uint64_t failures = 0;
+};
+
+template<typename Arena>
+static void perform(Arena& arena, const ReplayEvent& event, ThreadSamples& samples)
+{
+    auto start = replay_clock::now();
+    if (event.kind == ArenaEvent::Reset) {
+        arena.reset();
+    } else {
+        void* ptr = arena.allocate_bytes(event.size ? event.size : 1, event.alignment);
+        do_not_optimize(ptr);
+        if (!ptr) {
+            samples.failures++;
+        }
+    }
+    samples.latencies.push_back(std::chrono::duration<float, std::nano>(replay_clock::now() - start).count());
+}
+
+// Recorded order: a shared turn counter hands each event to its thread.
+template<typename Arena>
+static double replay_ordered(const Trace& trace, std::vector<std::unique_ptr<Arena>>& arenas,
+                             std::vector<ThreadSamples>& samples)
+{
+    std::atomic<uint64_t> turn{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < trace.threads.size(); ++t) {
+        threads.emplace_back([&, t]() {
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            for (const ReplayEvent& event : trace.threads[t]) {
+                while (turn.load(std::memory_order_acquire) != event.index) {
+                    std::this_thread::yield();
+                }
+                perform(*arenas[event.arena], event, samples[t]);
+                turn.store(event.index + 1, std::memory_order_release);
+            }
+        });
+    }
+    auto start = replay_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return std::chrono::duration<double, std::milli>(replay_clock::now() - start).count();
+}
+
+// Free running: threads race through the allocations between two resets; each
+// reset waits for every thread to reach it and then runs on its own.
+template<typename Arena>
+static double replay_free_running(const Trace& trace, std::vector<std::unique_ptr<Arena>>& arenas,
+                                  std::vector<ThreadSamples>& samples)
+{
+    std::vector<uint64_t> resets;
+    for (const auto& events : trace.threads) {
+        for (const ReplayEvent& event : events) {
+            if (event.kind == ArenaEvent::Reset) {
+                resets.push_back(event.index);
+            }
+        }
+    }
+    std::sort(resets.begin(), resets.end());
+    resets.push_back(UINT64_MAX);
+
+    std::vector<size_t> positions(trace.threads.size(), 0);
+    double wall_ms = 0.0;
+    for (uint64_t barrier : resets) {
+        std::atomic<bool> go{false};
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < trace.threads.size(); ++t) {
+            threads.emplace_back([&, t]() {
+                while (!go.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                const auto& events = trace.threads[t];
+                size_t& position = positions[t];
+                while (position < events.size() && events[position].index < barrier) {
+                    perform(*arenas[events[position].arena], events[position], samples[t]);
+                    ++position;
+                }
+            });
+        }
+        auto start = replay_clock::now();
+        go.store(true, std::memory_order_release);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        for (size_t t = 0; barrier != UINT64_MAX && t < trace.threads.size(); ++t) {
+            const auto& events = trace.threads[t];
+            if (positions[t] < events.size() && events[positions[t]].index == barrier) {
+                perform(*arenas[events[positions[t]].arena], events[positions[t]], samples[t]);
+                ++positions[t];
+            }
+        }
+        wall_ms += std::chrono::duration<double, std::milli>(replay_clock::now() - start).count();
+    }
+    return wall_ms;
+}
+
+template<typename Arena>
+static ReplayResult replay(const Trace& trace, const ArenaOptions& options, size_t capacity)
+{
+    std::vector<std::unique_ptr<Arena>> arenas;
+    for (uint32_t i = 0; i < trace.arena_count; ++i) {
+        arenas.emplace_back(new Arena(capacity, options));
+    }
+    std::vector<ThreadSamples> samples(trace.threads.size());
+    for (size_t t = 0; t < trace.threads.size(); ++t) {
+        samples[t].latencies.reserve(trace.threads[t].size());
+    }
+
+    ReplayResult result{};
+    result.wall_ms = free_running ? replay_free_running(trace, arenas, samples)
+                                  : replay_ordered(trace, arenas, samples);
+
+    std::vector<float> latencies;
+    latencies.reserve(static_cast<size_t>(trace.event_count));
+    for (const ThreadSamples& thread : samples) {
+        latencies.insert(latencies.end(), thread.latencies.begin(), thread.latencies.end());
+        result.failures += thread.failures;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    result.operations = latencies.size();
+    if (!latencies.empty()) {
+        size_t last = latencies.size() - 1;
+        result.p50_ns = latencies[last / 2];
+        result.p99_ns = latencies[std::min(last, latencies.size() * 99 / 100)];
+        result.p999_ns = latencies[std::min(last, latencies.size() * 999 / 1000)];
+        result.max_ns = latencies[last];
+    }
+    return result;
+}
+
+static ReplayResult run_config(const Trace& trace, const ReplayConfig& config)
+{
+    ArenaOptions options;
+    options.backing = config.backing;
+    options.growth = config.growth;
+    options.block_size = config.growth == GrowthPolicy::Linear ? block_size : 0;
+    if (config.lock == LockChoice::LockFree) {
+        options.flags = ArenaFlags::LockFree;
+    }
+    size_t capacity = capacity_override;
+    if (!capacity) {
+        capacity = config.growth == GrowthPolicy::Fixed ? std::max<size_t>(trace.peak_bytes, 4096) : block_size;
+    }
+
+    if (config.lock == LockChoice::Null) {
+        return replay<BasicArena<NullLock>>(trace, options, capacity);
+    }
+    return replay<MemoryArena>(trace, options, capacity);
+}
+
+// Runs the configuration in a child so that ru_maxrss covers it alone. The
+// result comes back through a pipe.
+static bool run_isolated(const Trace& trace, const ReplayConfig& config, ReplayResult& result)
+{
+#ifdef ARENA_REPLAY_FORK
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return false;
+    }
+    std::fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        ReplayResult child = run_config(trace, config);
+        bool written = write(fds[1], &child, sizeof(child)) == static_cast<ssize_t>(sizeof(child));
+        _exit(written ? 0 : 1);
+    }
+    close(fds[1]);
+    bool received = read(fds[0], &result, sizeof(result)) == static_cast<ssize_t>(sizeof(result));
+    close(fds[0]);
+    int status = 0;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        return false;
+    }
+    result.peak_rss_kb = usage.ru_maxrss;
+    return received;
+#else
+    result = run_config(trace, config);
+    result.peak_rss_kb = 0;
+    return true;
+#endif
+}
+
+static const char* lock_name(LockChoice lock)
+{
+    return lock == LockChoice::Mutex ? "mutex" : lock == LockChoice::LockFree ? "lockfree" : "null";
+}
+
+static const char* backing_name(BackingPolicy backing)
+{
+    return backing == BackingPolicy::Heap ? "heap" : "mmap";
+}
+
+static const char* growth_name(GrowthPolicy growth)
+{
+    return growth == GrowthPolicy::Fixed ? "fixed" : growth == GrowthPolicy::Linear ? "linear" : "geometric";
+}
+
+// A request-handling mix: mostly small records, a tail of buffers, a reset
+// per request batch, all spread over a few threads sharing one arena.
+static bool synthesize(const char* path, unsigned threads, size_t events)
+{
+    std::mt19937_64 random(42);
+    std::vector<Record> records;
+    records.reserve(events);
+    uint64_t timestamp = 0;
+    for (size_t i = 0; i < events; ++i) {
+        timestamp += 20 + random() % 200;
+        uint32_t thread = static_cast<uint32_t>(1 + random() % threads);
+        if (i % 5000 == 4999) {
+            records.push_back(Record{timestamp, thread, 0, ArenaEvent::Reset, 0, 1});
+            continue;
+        }
+        uint64_t roll = random() % 100;
+        uint64_t size = roll < 70 ? 8 + random() % 120 : roll < 95 ? 128 + random() % 1024 : 4096 + random() % 60000;
+        uint64_t alignment = roll < 90 ? 8 : 64;
+        records.push_back(Record{timestamp, thread, 0, ArenaEvent::Allocate, size, alignment});
+    }
+    std::ofstream out(path, std::ios::binary);
+    return ArenaTraceRecorder::write_records(out, records) && static_cast<bool>(out.flush());
+}
+
+static size_t parse_size(const char* text)
+{
+    return static_cast<size_t>(std::strtoull(text, nullptr, 0));
+}
+
+int main(int argc, char** argv)
+{
+    const char* trace_path = nullptr;
+    const char* synthesize_path = nullptr;
+    unsigned synthesize_threads = 4;
+    size_t synthesize_events = 200000;
+    std::vector<LockChoice> locks = {LockChoice::Mutex, LockChoice::LockFree, LockChoice::Null};
+    std::vector<BackingPolicy> backings = {BackingPolicy::Heap, BackingPolicy::Mmap};
+    std::vector<GrowthPolicy> growths = {GrowthPolicy::Fixed, GrowthPolicy::Linear, GrowthPolicy::Geometric};
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : "";
+        if (arg == "--lock" && i + 1 < argc) {
+            locks = {std::strcmp(value, "lockfree") == 0 ? LockChoice::LockFree
+                     : std::strcmp(value, "null") == 0 ? LockChoice::Null : LockChoice::Mutex};
+            ++i;
+        } else if (arg == "--backing" && i + 1 < argc) {
+            backings = {std::strcmp(value, "mmap") == 0 ? BackingPolicy::Mmap : BackingPolicy::Heap};
+            ++i;
+        } else if (arg == "--growth" && i + 1 < argc) {
+            growths = {std::strcmp(value, "linear") == 0 ? GrowthPolicy::Linear
+                       : std::strcmp(value, "geometric") == 0 ? GrowthPolicy::Geometric : GrowthPolicy::Fixed};
+            ++i;
+        } else if (arg == "--capacity" && i + 1 < argc) {
+            capacity_override = parse_size(value);
+            ++i;
+        } else if (arg == "--block-size" && i + 1 < argc) {
+            block_size = std::max<size_t>(parse_size(value), 4096);
+            ++i;
+        } else if (arg == "--free-running") {
+            free_running = true;
+        } else if (arg == "--synthesize" && i + 1 < argc) {
+            synthesize_path = value;
+            ++i;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            synthesize_threads = std::max(1u, static_cast<unsigned>(parse_size(value)));
+            ++i;
+        } else if (arg == "--events" && i + 1 < argc) {
+            synthesize_events = parse_size(value);
+            ++i;
+        } else if (arg[0] != '-' && !trace_path) {
+            trace_path = argv[i];
+        } else {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    if (synthesize_path) {
+        if (!synthesize(synthesize_path, synthesize_threads, synthesize_events)) {
+            std::fprintf(stderr, "cannot write %s\n", synthesize_path);
+            return 1;
+        }
+        std::printf("Wrote %zu events on %u threads to %s\n", synthesize_events, synthesize_threads, synthesize_path);
+        return 0;
+    }
+    if (!trace_path) {
+        std::fprintf(stderr, "usage: %s TRACE [options] | --synthesize TRACE [--threads N] [--events N]\n", argv[0]);
+        std::fprintf(stderr, "Traces record allocations, failures and resets only; frees and rewinds are not replayed.\n");
+        return 2;
+    }
+
+    Trace trace;
+    if (!load_trace(trace_path, trace)) {
+        std::fprintf(stderr, "cannot read trace %s\n", trace_path);
+        return 1;
+    }
+
+    std::printf("=== Memory Arena Trace Replay ===\n");
+    std::printf("Trace: %s, %llu events, %zu threads, %u arenas, %s order\n", trace_path,
+                static_cast<unsigned long long>(trace.event_count), trace.threads.size(), trace.arena_count,
+                free_running ? "free-running" : "recorded");
+    std::printf("\n%-28s %10s %10s %10s %10s %10s %10s %8s %10s\n", "Configuration", "Mops/s", "p50 (ns)",
+                "p99 (ns)", "p99.9 (ns)", "max (ns)", "wall (ms)", "failed", "RSS (KiB)");
+    std::printf("%s\n", std::string(116, '-').c_str());
+
+    for (LockChoice lock : locks) {
+        if (lock == LockChoice::Null && free_running && trace.threads.size() > 1) {
+            continue;
+        }
+        for (BackingPolicy backing : backings) {
+            for (GrowthPolicy growth : growths) {
+                ReplayConfig config{lock, backing, growth};
+                std::string name = std::string(lock_name(lock)) + "/" + backing_name(backing) + "/" + growth_name(growth);
+                ReplayResult result;
+                if (!run_isolated(trace, config, result)) {
+                    std::printf("%-28s replay failed\n", name.c_str());
+                    continue;
+                }
+                double mops = result.wall_ms > 0.0 ? result.operations / (result.wall_ms * 1000.0) : 0.0;
+                std::printf("%-28s %10.2f %10.1f %10.1f %10.1f %10.1f %10.2f %8llu %10ld\n", name.c_str(), mops,
+                            result.p50_ns, result.p99_ns, result.p999_ns, result.max_ns, result.wall_ms,
+                            static_cast<unsigned long long>(result.failures), result.peak_rss_kb);
+            }
+        }
+    }
+    return 0;
+}
@@ -1,4 +1,21 @@
+#define ARENA_ENABLE_STATS 1
+#define ARENA_ENABLE_HOOKS 1
 #include "Arena.hpp"
+#include "ThreadLocalArena.hpp"
+#include "ArenaSet.hpp"
+#include "ArenaAllocator.hpp"
+#include "TypedPool.hpp"
+#include "ArenaHeap.hpp"
+#include "ArenaTrace.hpp"
+#include "GenerationalArena.hpp"
+#include "StaticArena.hpp"
+#include "ArenaSoA.hpp"
+#include "ArenaFlatMap.hpp"
+#include "ArenaStringInterner.hpp"
+#include "ArenaSnapshot.hpp"
+#include "SharedArena.hpp"
+#include "ArenaCoroutine.hpp"
+#include "ArenaScheduler.hpp"
 #include <iostream>
 #include <cassert>
 #include <thread>
@@ -6,6 +23,11 @@
 #include <chrono>
 #include <atomic>
 #include <cstring>
+#include <string>
+#include <unordered_map>
+#include <sstream>
+#include <cstdio>
+#include <sys/wait.h>
 
 // Struct with specific alignment requirements
 struct alignas(16) AlignedStruct {
@@ -63,11 +85,80 @@ void test_alignment_padding() {
     size_t actual_used = initial_remaining - arena.remaining();
     
     // The actual used space should account for padding
-    assert(actual_used >= sizeof(char) + sizeof(double));
+    assert(actual_used == expected_used);
     
     std::cout << "✓ Alignment padding works correctly" << std::endl;
 }
 
+void test_mark_and_rewind() {
+    std::cout << "Testing mark/rewind and ArenaScope..." << std::endl;
+    
+    MemoryArena arena(1024);
+    char* char_ptr = arena.allocate<char>();
+    assert(char_ptr != nullptr);
+    size_t before = arena.remaining();
+    
+    // Padding inserted for the double is reclaimed too
+    MemoryArena::Marker marker = arena.mark();
+    double* double_ptr = arena.allocate<double>();
+    AlignedStruct* aligned = arena.allocate<AlignedStruct>();
+    assert(double_ptr && aligned);
+    arena.rewind(marker);
+    assert(arena.remaining() == before);
+    
+    // Repeated cycles do not leak
+    for (int i = 0; i < 1000; ++i) {
+        ArenaScope scope(arena);
+        assert(arena.allocate<double>() != nullptr);
+        assert(arena.allocate<char>() != nullptr);
+    }
+    assert(arena.remaining() == before);
+    
+    // Nested scopes
+    {
+        ArenaScope outer(arena);
+        arena.allocate_array<int>(10);
+        size_t in_outer = arena.remaining();
+        {
+            ArenaScope inner(arena);
+            arena.allocate_array<int>(20);
+            assert(arena.remaining() < in_outer);
+        }
+        assert(arena.remaining() == in_outer);
+    }
+    assert(arena.remaining() == before);
+    
+    // Markers taken before reset() are ignored
+    MemoryArena::Marker stale = arena.mark();
+    arena.reset();
+    arena.allocate<int>();
+    size_t after_reset = arena.remaining();
+    arena.rewind(stale);
+    assert(arena.remaining() == after_reset);
+    
+    // Rewinding across chained blocks turns them back into spares
+    ArenaOptions options;
+    options.growth = GrowthPolicy::Linear;
+    MemoryArena growing(64, options);
+    growing.allocate<int>();
+    size_t growing_before = growing.remaining_in_block();
+    {
+        ArenaScope scope(growing);
+        for (int i = 0; i < 64; ++i) {
+            assert(growing.allocate<int>() != nullptr);
+        }
+        assert(growing.usage().block_count > 1);
+    }
+    assert(growing.remaining_in_block() == growing_before);
+    size_t blocks = growing.usage().block_count;
+    for (int i = 0; i < 64; ++i) {
+        assert(growing.allocate<int>() != nullptr);
+    }
+    assert(growing.usage().block_count == blocks);
+    
+    std::cout << "✓ Mark/rewind works correctly" << std::endl;
+}
+
 void test_potential_crashes_buffer_overrun() {
     std::cout << "Testing potential buffer overrun scenarios..." << std::endl;
     
@@ -76,10 +167,11 @@ void test_potential_crashes_buffer_overrun() {
     
     // Fill up the arena completely
     std::vector<int*> ptrs;
+    const int pattern = static_cast<int>(0xDEADBEEF);
     int* ptr;
     while ((ptr = tiny_arena.allocate<int>()) != nullptr) {
         ptrs.push_back(ptr);
-        *ptr = 0xDEADBEEF; // Write pattern to verify memory
+        *ptr = pattern; // Write pattern to verify memory
     }
     
     // Try to allocate when arena is full - should return nullptr
@@ -88,7 +180,7 @@ void test_potential_crashes_buffer_overrun() {
     
     // Verify existing data is still intact
     for (int* p : ptrs) {
-        assert(*p == 0xDEADBEEF);
+        assert(*p == pattern);
     }
     
     std::cout << "✓ Buffer overrun protection works" << std::endl;
@@ -120,6 +212,161 @@ void test_deallocate_crash_scenarios() {
     std::cout << "✓ Deallocation edge cases tested" << std::endl;
 }
 
+void test_growable_arena() {
+    std::cout << "Testing growable chained-block arena..." << std::endl;
+    
+    // Geometric growth chains blocks of 64, 128, 256... bytes
+    ArenaOptions geometric;
+    geometric.growth = GrowthPolicy::Geometric;
+    MemoryArena arena(64, geometric);
+    
+    std::vector<int*> ptrs;
+    for (int i = 0; i < 100; ++i) {
+        int* ptr = arena.allocate<int>();
+        assert(ptr != nullptr);
+        *ptr = i;
+        ptrs.push_back(ptr);
+    }
+    for (int i = 0; i < 100; ++i) {
+        assert(*ptrs[i] == i);
+    }
+    ArenaUsage usage = arena.usage();
+    assert(usage.block_count > 1);
+    assert(usage.total_capacity >= 100 * sizeof(int));
+    assert(usage.block_capacity > 64);
+    
+    // Oversized requests get a block of their own
+    double* big = arena.allocate_array<double>(1000);
+    assert(big != nullptr);
+    assert(reinterpret_cast<uintptr_t>(big) % alignof(double) == 0);
+    
+    // Reset keeps only the largest block by default
+    size_t largest = arena.usage().block_capacity;
+    arena.reset();
+    usage = arena.usage();
+    assert(usage.block_count == 1);
+    assert(usage.block_capacity == largest);
+    assert(arena.remaining() == largest);
+    
+    // Linear growth with a hard cap
+    ArenaOptions capped;
+    capped.growth = GrowthPolicy::Linear;
+    capped.block_size = 32;
+    capped.max_capacity = 128;
+    MemoryArena capped_arena(32, capped);
+    int count = 0;
+    while (capped_arena.allocate<int>() != nullptr) {
+        count++;
+    }
+    assert(count == 128 / sizeof(int));
+    assert(capped_arena.usage().total_capacity == 128);
+    
+    // KeepAll retains spares across resets and reuses them
+    ArenaOptions retain;
+    retain.growth = GrowthPolicy::Linear;
+    retain.retain = RetainPolicy::KeepAll;
+    MemoryArena retain_arena(64, retain);
+    for (int i = 0; i < 64; ++i) {
+        assert(retain_arena.allocate<int>() != nullptr);
+    }
+    size_t blocks_before = retain_arena.usage().block_count;
+    retain_arena.reset();
+    assert(retain_arena.usage().block_count == blocks_before);
+    assert(retain_arena.remaining() == blocks_before * 64);
+    assert(retain_arena.remaining_in_block() == 64);
+    for (int i = 0; i < 64; ++i) {
+        assert(retain_arena.allocate<int>() != nullptr);
+    }
+    assert(retain_arena.usage().block_count == blocks_before);
+    
+    // Lock-free bumping across block boundaries
+    ArenaOptions lock_free_growth;
+    lock_free_growth.flags = ArenaFlags::LockFree;
+    lock_free_growth.growth = GrowthPolicy::Linear;
+    MemoryArena shared(256, lock_free_growth);
+    std::vector<std::thread> threads;
+    std::atomic<int> failures{0};
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t]() {
+            std::vector<int*> mine;
+            for (int i = 0; i < 500; ++i) {
+                int* ptr = shared.allocate<int>();
+                if (!ptr) {
+                    failures++;
+                    continue;
+                }
+                *ptr = t;
+                mine.push_back(ptr);
+            }
+            for (int* ptr : mine) {
+                if (*ptr != t) {
+                    failures++;
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    assert(failures.load() == 0);
+    
+    std::cout << "✓ Growable arena works correctly" << std::endl;
+}
+
+void test_mmap_backed_arena() {
+    std::cout << "Testing mmap-backed arena..." << std::endl;
+    
+    // Reserve a large virtual range; only touched pages are committed
+    ArenaOptions options;
+    options.backing = BackingPolicy::Mmap;
+    options.commit_granularity = 64 * 1024;
+    options.purge_above = 0;
+    MemoryArena arena(size_t(1) << 30, options);
+    assert(arena.usage().block_capacity >= (size_t(1) << 30));
+    
+    int* first = arena.allocate<int>();
+    assert(first != nullptr);
+    *first = 7;
+    
+    // Allocations across several commit steps stay usable
+    char* buffer = arena.allocate_array_uninit<char>(1 << 20);
+    assert(buffer != nullptr);
+    std::memset(buffer, 0xAB, 1 << 20);
+    AlignedStruct* aligned = arena.allocate<AlignedStruct>();
+    assert(aligned != nullptr);
+    assert(reinterpret_cast<uintptr_t>(aligned) % 16 == 0);
+    
+    // reset() with purge_above = 0 hands every page back; they read as zero again
+    arena.reset();
+    char* again = arena.allocate_array_uninit<char>(1 << 20);
+    assert(again != nullptr);
+    assert(again[0] == 0 && again[(1 << 20) - 1] == 0);
+    
+    // Huge page requests fall back gracefully when the system has none
+    ArenaOptions huge;
+    huge.backing = BackingPolicy::Mmap;
+    huge.huge_pages = HugePages::Explicit;
+    MemoryArena huge_arena(size_t(4) << 20, huge);
+    double* values = huge_arena.allocate_array<double>(1024);
+    assert(values != nullptr);
+    values[1023] = 1.0;
+    
+    ArenaOptions transparent;
+    transparent.backing = BackingPolicy::Mmap;
+    transparent.huge_pages = HugePages::Transparent;
+    transparent.growth = GrowthPolicy::Geometric;
+    transparent.flags = ArenaFlags::LockFree;
+    MemoryArena growing(64 * 1024, transparent);
+    for (int i = 0; i < 100000; ++i) {
+        int* ptr = growing.allocate<int>();
+        assert(ptr != nullptr);
+        *ptr = i;
+    }
+    assert(growing.usage().block_count > 1);
+    
+    std::cout << "✓ mmap-backed arena works correctly" << std::endl;
+}
+
 void test_thread_safety_concurrent_allocation() {
     std::cout << "Testing thread safety - concurrent allocation..." << std::endl;
     
@@ -157,6 +404,211 @@ void test_thread_safety_concurrent_allocation() {
     std::cout << "✓ Concurrent allocation thread safety tested" << std::endl;
 }
 
+void test_lock_free_allocation() {
+    std::cout << "Testing lock-free allocation mode..." << std::endl;
+    
+    MemoryArena arena(64, ArenaFlags::LockFree);
+    assert(arena.is_lock_free());
+    
+    // Alignment is still honoured by the CAS path
+    char* char_ptr = arena.allocate<char>();
+    double* double_ptr = arena.allocate<double>();
+    assert(char_ptr && double_ptr);
+    assert(reinterpret_cast<uintptr_t>(double_ptr) % alignof(double) == 0);
+    
+    // Exhaustion still returns nullptr
+    while (arena.allocate<int>() != nullptr) {}
+    assert(arena.allocate<int>() == nullptr);
+    assert(arena.allocate_array<int>(4) == nullptr);
+    
+    arena.reset();
+    assert(arena.remaining() == 64);
+    
+    // Concurrent allocations must never hand out overlapping slots
+    const int num_threads = 8;
+    const int allocations_per_thread = 1000;
+    MemoryArena shared(num_threads * allocations_per_thread * sizeof(int), ArenaFlags::LockFree);
+    std::vector<std::thread> threads;
+    std::vector<std::vector<int*>> results(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < allocations_per_thread; ++i) {
+                int* ptr = shared.allocate<int>();
+                assert(ptr != nullptr);
+                *ptr = t;
+                results[t].push_back(ptr);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    for (int t = 0; t < num_threads; ++t) {
+        for (int* ptr : results[t]) {
+            assert(*ptr == t);
+        }
+    }
+    assert(shared.remaining() == 0);
+    
+    std::cout << "✓ Lock-free allocation works correctly" << std::endl;
+}
+
+void test_thread_safety_contention_benchmark() {
+    std::cout << "Benchmarking allocation throughput by thread count..." << std::endl;
+    
+    const int allocations_per_thread = 20000;
+    const int thread_counts[] = {1, 2, 4, 8, 16, 32};
+    
+    for (ArenaFlags flags : {ArenaFlags::None, ArenaFlags::LockFree}) {
+        const char* label = has_flag(flags, ArenaFlags::LockFree) ? "lock-free" : "mutex    ";
+        for (int num_threads : thread_counts) {
+            MemoryArena arena(num_threads * allocations_per_thread * sizeof(int), flags);
+            std::atomic<bool> go{false};
+            std::vector<std::thread> threads;
+            for (int t = 0; t < num_threads; ++t) {
+                threads.emplace_back([&]() {
+                    while (!go.load()) { std::this_thread::yield(); }
+                    for (int i = 0; i < allocations_per_thread; ++i) {
+                        int* ptr = arena.allocate<int>();
+                        assert(ptr != nullptr);
+                        *ptr = i;
+                    }
+                });
+            }
+            
+            auto start_time = std::chrono::high_resolution_clock::now();
+            go = true;
+            for (auto& t : threads) {
+                t.join();
+            }
+            auto end_time = std::chrono::high_resolution_clock::now();
+            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+            
+            double total = static_cast<double>(num_threads) * allocations_per_thread;
+            double mops = duration.count() > 0 ? total / duration.count() : 0.0;
+            std::cout << "  " << label << " threads=" << num_threads
+                      << " " << mops << " Mallocs/s" << std::endl;
+            assert(arena.remaining() == 0);
+        }
+    }
+    
+    std::cout << "✓ Contention benchmark completed" << std::endl;
+}
+
+void test_thread_local_arena() {
+    std::cout << "Testing thread-local arena front-end..." << std::endl;
+    
+    MemoryArena parent(4096);
+    ThreadLocalArena local(parent, 1024);
+    
+    // First allocation carves one chunk out of the parent
+    int* first = local.allocate<int>();
+    assert(first != nullptr);
+    assert(parent.remaining() <= 4096 - 1024);
+    size_t parent_after_first_chunk = parent.remaining();
+    
+    // Further small allocations do not touch the parent
+    double* d = local.allocate<double>();
+    AlignedStruct* aligned = local.allocate<AlignedStruct>();
+    assert(d && aligned);
+    assert(reinterpret_cast<uintptr_t>(aligned) % 16 == 0);
+    assert(parent.remaining() == parent_after_first_chunk);
+    
+    // Running out of the chunk refills from the parent
+    int* big = local.allocate_array<int>(300);
+    assert(big != nullptr);
+    assert(parent.remaining() < parent_after_first_chunk);
+    
+    // Parent reset invalidates the cached chunk
+    parent.reset();
+    assert(local.remaining() == 0);
+    int* after_reset = local.allocate<int>();
+    assert(after_reset != nullptr);
+    assert(parent.remaining() <= 4096 - 1024);
+    
+    // Parent exhaustion surfaces as nullptr
+    assert(local.allocate_array<char>(8192) == nullptr);
+    
+    // One front-end per worker thread
+    const int num_threads = 4;
+    const int allocations_per_thread = 1000;
+    MemoryArena shared(num_threads * 64 * 1024, ArenaFlags::LockFree);
+    std::vector<std::thread> threads;
+    std::atomic<int> failures{0};
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t]() {
+            ThreadLocalArena worker_arena(shared);
+            std::vector<int*> ptrs;
+            for (int i = 0; i < allocations_per_thread; ++i) {
+                int* ptr = worker_arena.allocate<int>();
+                if (!ptr) {
+                    failures++;
+                    continue;
+                }
+                *ptr = t;
+                ptrs.push_back(ptr);
+            }
+            for (int* ptr : ptrs) {
+                if (*ptr != t) {
+                    failures++;
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    assert(failures.load() == 0);
+    
+    std::cout << "✓ Thread-local arena works correctly" << std::endl;
+}
+
+void test_numa_arena_set() {
+    std::cout << "Testing NUMA arena set..." << std::endl;
+    
+    ArenaSet set(1 << 20);
+    assert(set.node_count() >= 1);
+    assert(ArenaSet::current_node() >= 0);
+    
+    // Node-bound arenas behave like any other mmap-backed arena
+    for (size_t i = 0; i < set.node_count(); ++i) {
+        int* ptr = set.node(i).allocate<int>();
+        assert(ptr != nullptr);
+        *ptr = static_cast<int>(i);
+    }
+    
+    // Each worker takes its node-local arena and fronts it per thread
+    const int num_threads = 4;
+    std::vector<std::thread> threads;
+    std::atomic<int> failures{0};
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t]() {
+            ThreadLocalArena local(set.local(), 4096);
+            for (int i = 0; i < 1000; ++i) {
+                int* ptr = local.allocate<int>();
+                if (!ptr) {
+                    failures++;
+                    continue;
+                }
+                *ptr = t;
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    assert(failures.load() == 0);
+    
+    // An explicit node count works even on single-node machines
+    ArenaSet forced(64 * 1024, 2, ArenaOptions{});
+    assert(forced.node_count() == 2);
+    assert(forced.node(1).allocate<double>() != nullptr);
+    forced.reset();
+    assert(forced.node(1).remaining() == forced.node(1).usage().block_capacity);
+    
+    std::cout << "✓ NUMA arena set works correctly" << std::endl;
+}
+
 void test_thread_safety_alloc_dealloc_race() {
     std::cout << "Testing thread safety - allocation/deallocation race..." << std::endl;
     
@@ -340,6 +792,63 @@ void test_destructor_calls() {
     std::cout << "✓ Destructors called correctly" << std::endl;
 }
 
+void test_reset_runs_destructors() {
+    std::cout << "Testing destructor registry on reset and rewind..." << std::endl;
+    
+    TestObject::reset_counters();
+    {
+        MemoryArena arena(4096);
+        
+        arena.allocate<TestObject>();
+        arena.allocate_array<TestObject>(3);
+        arena.allocate<int>();
+        assert(TestObject::constructor_count == 4);
+        
+        // reset() destroys everything still alive
+        arena.reset();
+        assert(TestObject::destructor_count == 4);
+        
+        // Objects destroyed by hand are not destroyed again
+        TestObject::reset_counters();
+        TestObject* kept = arena.allocate<TestObject>();
+        TestObject* released = arena.allocate<TestObject>();
+        arena.deallocate<TestObject>(released);
+        assert(TestObject::destructor_count == 1);
+        assert(kept->value == 42);
+        arena.reset();
+        assert(TestObject::destructor_count == 2);
+        
+        // LIFO deallocation reclaims the bookkeeping as well
+        size_t before = arena.remaining();
+        TestObject* array = arena.allocate_array<TestObject>(2);
+        arena.deallocate_array<TestObject>(array, 2);
+        assert(arena.remaining() == before);
+        
+        // Scopes destroy only what was allocated inside them
+        TestObject::reset_counters();
+        arena.allocate<TestObject>();
+        {
+            ArenaScope scope(arena);
+            arena.allocate<TestObject>();
+            arena.allocate_array<TestObject>(2);
+        }
+        assert(TestObject::destructor_count == 3);
+        
+        // Trivial types carry no bookkeeping
+        arena.reset();
+        before = arena.remaining();
+        arena.allocate<int>();
+        assert(before - arena.remaining() == sizeof(int));
+        
+        TestObject::reset_counters();
+        arena.allocate<TestObject>();
+    }
+    // The arena destructor finalizes the rest
+    assert(TestObject::destructor_count == 1);
+    
+    std::cout << "✓ Destructor registry works correctly" << std::endl;
+}
+
 void test_array_allocation() {
     std::cout << "Testing array allocation..." << std::endl;
     
@@ -370,6 +879,185 @@ void test_array_allocation() {
     std::cout << "✓ Array allocation works correctly" << std::endl;
 }
 
+void test_array_uninit_and_zeroed() {
+    std::cout << "Testing uninitialized and zeroed array allocation..." << std::endl;
+    
+    MemoryArena arena(4096);
+    
+    // Dirty the memory, then hand it out again
+    MemoryArena::Marker marker = arena.mark();
+    int* dirty = arena.allocate_array_uninit<int>(256);
+    assert(dirty != nullptr);
+    std::memset(dirty, 0xFF, 256 * sizeof(int));
+    arena.rewind(marker);
+    
+    int* zeroed = arena.allocate_array_zeroed<int>(256);
+    assert(zeroed == dirty);
+    for (int i = 0; i < 256; ++i) {
+        assert(zeroed[i] == 0);
+    }
+    
+    // Alignment and bounds match allocate_array
+    char* odd = arena.allocate_array_uninit<char>(3);
+    double* doubles = arena.allocate_array_uninit<double>(4);
+    assert(odd && doubles);
+    assert(reinterpret_cast<uintptr_t>(doubles) % alignof(double) == 0);
+    assert(arena.allocate_array_uninit<int>(0) == nullptr);
+    assert(arena.allocate_array_zeroed<int>(SIZE_MAX / sizeof(int) + 1) == nullptr);
+    assert(arena.allocate_array_zeroed<int>(100000) == nullptr);
+    
+    // Large scratch buffers
+    MemoryArena large(16 * 1024 * 1024);
+    auto start_time = std::chrono::high_resolution_clock::now();
+    double* scratch = large.allocate_array_uninit<double>(1024 * 1024);
+    auto uninit_time = std::chrono::high_resolution_clock::now();
+    large.reset();
+    double* cleared = large.allocate_array_zeroed<double>(1024 * 1024);
+    auto zeroed_time = std::chrono::high_resolution_clock::now();
+    large.reset();
+    double* value_init = large.allocate_array<double>(1024 * 1024);
+    auto value_time = std::chrono::high_resolution_clock::now();
+    assert(scratch && cleared && value_init);
+    assert(cleared[1024 * 1024 - 1] == 0.0);
+    
+    using us = std::chrono::microseconds;
+    std::cout << "  8 MB uninit: " << std::chrono::duration_cast<us>(uninit_time - start_time).count()
+              << " μs, zeroed: " << std::chrono::duration_cast<us>(zeroed_time - uninit_time).count()
+              << " μs, value-initialized: " << std::chrono::duration_cast<us>(value_time - zeroed_time).count()
+              << " μs" << std::endl;
+    
+    std::cout << "✓ Uninitialized and zeroed arrays work correctly" << std::endl;
+}
+
+struct RecordHeader {
+    uint32_t length;
+    uint32_t kind;
+};
+
+void test_allocate_bytes_and_extend() {
+    std::cout << "Testing runtime-size allocation and in-place extension..." << std::endl;
+    
+    MemoryArena arena(4096);
+    
+    // Runtime size and alignment
+    arena.allocate<char>();
+    void* blob = arena.allocate_bytes(100, 64);
+    assert(blob != nullptr);
+    assert(reinterpret_cast<uintptr_t>(blob) % 64 == 0);
+    assert(arena.allocate_bytes(0, 8) == nullptr);
+    assert(arena.allocate_bytes(16, 3) == nullptr);
+    assert(arena.allocate_bytes(8192, 8) == nullptr);
+    
+    // Header plus payload record that grows while it is the last allocation
+    RecordHeader* record = static_cast<RecordHeader*>(arena.allocate_bytes(sizeof(RecordHeader), alignof(RecordHeader)));
+    assert(record != nullptr);
+    record->length = 0;
+    size_t size = sizeof(RecordHeader);
+    for (int i = 0; i < 100; ++i) {
+        assert(arena.try_extend(record, size, size + 4));
+        char* payload = reinterpret_cast<char*>(record) + size;
+        std::memcpy(payload, "abcd", 4);
+        size += 4;
+        record->length += 4;
+    }
+    assert(record->length == 400);
+    
+    // Shrinking the top allocation gives the tail back
+    size_t before = arena.remaining();
+    assert(arena.try_extend(record, size, sizeof(RecordHeader)));
+    assert(arena.remaining() == before + 400);
+    
+    // Not the top allocation, or no room left: nothing changes
+    void* other = arena.allocate_bytes(8, 8);
+    assert(other != nullptr);
+    assert(!arena.try_extend(record, sizeof(RecordHeader), 64));
+    assert(!arena.try_extend(other, 8, 1 << 20));
+    assert(!arena.try_extend(nullptr, 0, 8));
+    assert(arena.try_extend(other, 8, 16));
+    
+    // Same behaviour in lock-free mode
+    MemoryArena lock_free(1024, ArenaFlags::LockFree);
+    void* buffer = lock_free.allocate_bytes(16, 16);
+    assert(lock_free.try_extend(buffer, 16, 512));
+    assert(lock_free.remaining() <= 1024 - 512);
+    assert(!lock_free.try_extend(buffer, 16, 32));
+    
+    std::cout << "✓ Runtime-size allocation and extension work correctly" << std::endl;
+}
+
+void test_reallocate_array() {
+    std::cout << "Testing array reallocation..." << std::endl;
+    
+    MemoryArena arena(64 * 1024);
+    
+    // Growing the top allocation stays in place, new elements are zeroed
+    int* numbers = arena.allocate_array<int>(4);
+    for (int i = 0; i < 4; ++i) {
+        numbers[i] = i;
+    }
+    int* grown = arena.reallocate_array<int>(numbers, 4, 64);
+    assert(grown == numbers);
+    for (int i = 0; i < 4; ++i) {
+        assert(grown[i] == i);
+    }
+    for (int i = 4; i < 64; ++i) {
+        assert(grown[i] == 0);
+    }
+    
+    // Amortized string-builder style growth never copies while on top
+    char* builder = arena.allocate_array<char>(1);
+    size_t length = 1;
+    for (int i = 0; i < 1000; ++i) {
+        char* next = arena.reallocate_array<char>(builder, length, length + 1);
+        assert(next == builder);
+        builder[length++] = 'x';
+    }
+    
+    // Shrinking the top allocation gives memory back
+    size_t before = arena.remaining();
+    builder = arena.reallocate_array<char>(builder, length, 1);
+    assert(arena.remaining() == before + length - 1);
+    
+    // Not on top: elements move into a fresh array
+    double* values = arena.allocate_array<double>(8);
+    for (int i = 0; i < 8; ++i) {
+        values[i] = i * 1.5;
+    }
+    arena.allocate<int>();
+    double* moved = arena.reallocate_array<double>(values, 8, 16);
+    assert(moved != nullptr && moved != values);
+    for (int i = 0; i < 8; ++i) {
+        assert(moved[i] == i * 1.5);
+    }
+    assert(moved[15] == 0.0);
+    
+    // Non-trivial elements are moved and finalized exactly once
+    std::string* strings = arena.allocate_array<std::string>(2);
+    strings[0] = "a string too long for the small buffer optimization";
+    strings[1] = "another string too long for the small buffer optimization";
+    strings = arena.reallocate_array<std::string>(strings, 2, 3);
+    strings[2] = "grown in place while still the most recent allocation";
+    arena.allocate<int>();
+    std::string* relocated = arena.reallocate_array<std::string>(strings, 3, 6);
+    assert(relocated != strings);
+    assert(relocated[0] == "a string too long for the small buffer optimization");
+    assert(relocated[2] == "grown in place while still the most recent allocation");
+    assert(relocated[5].empty());
+    relocated = arena.reallocate_array<std::string>(relocated, 6, 1);
+    assert(relocated[0] == "a string too long for the small buffer optimization");
+    
+    // Failure leaves the original untouched
+    MemoryArena small(256);
+    int* full = small.allocate_array<int>(16);
+    full[15] = 99;
+    assert(small.reallocate_array<int>(full, 16, 1000) == nullptr);
+    assert(full[15] == 99);
+    assert(small.reallocate_array<int>(nullptr, 0, 4) != nullptr);
+    
+    arena.reset();
+    std::cout << "✓ Array reallocation works correctly" << std::endl;
+}
+
 void test_array_constructors() {
     std::cout << "Testing array constructor calls..." << std::endl;
     
@@ -475,6 +1163,1643 @@ void test_mixed_allocation() {
     std::cout << "✓ Mixed allocation works correctly" << std::endl;
 }
 
+void test_stl_allocator() {
+    std::cout << "Testing STL allocator and pmr resource..." << std::endl;
+    
+    MemoryArena arena(64 * 1024);
+    size_t before = arena.remaining();
+    
+    // Standard containers with only a type change
+    std::vector<int, ArenaAllocator<int>> numbers{ArenaAllocator<int>(arena)};
+    for (int i = 0; i < 100; ++i) {
+        numbers.push_back(i);
+    }
+    assert(numbers[99] == 99);
+    assert(arena.remaining() < before);
+    
+    using Map = std::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+                                   ArenaAllocator<std::pair<const int, int>>>;
+    Map map{0, std::hash<int>(), std::equal_to<int>(), ArenaAllocator<std::pair<const int, int>>(arena)};
+    for (int i = 0; i < 50; ++i) {
+        map[i] = i * i;
+    }
+    assert(map[7] == 49);
+    
+    // Rebound allocators share the arena
+    ArenaAllocator<double> rebound(numbers.get_allocator());
+    assert(rebound == numbers.get_allocator());
+    assert(&rebound.arena() == &arena);
+    
+    // LIFO-aware deallocation rolls back the most recent allocation
+    size_t mid = arena.remaining_in_block();
+    AlignedStruct* top = ArenaAllocator<AlignedStruct>(arena).allocate(4);
+    ArenaAllocator<AlignedStruct>(arena).deallocate(top, 4);
+    assert(arena.remaining_in_block() <= mid && mid - arena.remaining_in_block() < alignof(AlignedStruct));
+    
+    // Exhaustion throws as the Allocator requirements demand
+    MemoryArena tiny(64);
+    bool threw = false;
+    try {
+        ArenaAllocator<int>(tiny).allocate(1000);
+    } catch (const std::bad_alloc&) {
+        threw = true;
+    }
+    assert(threw);
+    
+    // pmr containers
+    ArenaResource resource(arena);
+    std::pmr::vector<std::pmr::string> strings(&resource);
+    for (int i = 0; i < 20; ++i) {
+        strings.emplace_back("a string long enough to need a heap buffer #" + std::to_string(i));
+    }
+    assert(strings[19].back() == '9');
+    assert(strings.get_allocator().resource() == &resource);
+    ArenaResource other(arena);
+    assert(resource.is_equal(other));
+    assert(!resource.is_equal(*std::pmr::new_delete_resource()));
+    
+    std::cout << "✓ STL allocator and pmr resource work correctly" << std::endl;
+}
+
+struct PoolNode {
+    int key;
+    PoolNode* next;
+    PoolNode(int key, PoolNode* next) : key(key), next(next) {}
+};
+
+void test_typed_pool() {
+    std::cout << "Testing typed object pool..." << std::endl;
+    
+    MemoryArena arena(64 * 1024);
+    TypedPool<PoolNode> pool(arena, 16);
+    
+    // Allocate, then free in arbitrary order
+    std::vector<PoolNode*> nodes;
+    for (int i = 0; i < 40; ++i) {
+        PoolNode* node = pool.allocate(i, nullptr);
+        assert(node != nullptr);
+        assert(reinterpret_cast<uintptr_t>(node) % alignof(PoolNode) == 0);
+        nodes.push_back(node);
+    }
+    assert(pool.size() == 40);
+    assert(pool.capacity() == 48);
+    for (size_t i = 0; i < nodes.size(); i += 2) {
+        pool.deallocate(nodes[i]);
+    }
+    assert(pool.size() == 20);
+    
+    // Freed slots are reused before the pool asks the arena for more
+    size_t before = arena.remaining();
+    for (int i = 0; i < 20; ++i) {
+        PoolNode* node = pool.allocate(100 + i, nullptr);
+        assert(node != nullptr);
+        assert(node->key == 100 + i);
+    }
+    assert(arena.remaining() == before);
+    assert(pool.capacity() == 48);
+    for (size_t i = 1; i < nodes.size(); i += 2) {
+        assert(nodes[i]->key == static_cast<int>(i));
+    }
+    
+    // Destructors run on deallocate
+    TestObject::reset_counters();
+    TypedPool<TestObject> objects(arena);
+    TestObject* a = objects.allocate();
+    TestObject* b = objects.allocate();
+    objects.deallocate(a);
+    assert(TestObject::destructor_count == 1);
+    assert(objects.allocate() == a);
+    objects.deallocate(b);
+    
+    // An arena reset makes the pool start over with fresh slabs
+    arena.reset();
+    assert(pool.allocate(1, nullptr) != nullptr);
+    assert(pool.size() == 1);
+    assert(pool.capacity() == 16);
+    
+    // Concurrent allocate/free
+    TypedPool<PoolNode> shared(arena, 32);
+    std::vector<std::thread> threads;
+    std::atomic<int> failures{0};
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t]() {
+            std::vector<PoolNode*> mine;
+            for (int i = 0; i < 200; ++i) {
+                PoolNode* node = shared.allocate(t, nullptr);
+                if (!node) {
+                    failures++;
+                    continue;
+                }
+                mine.push_back(node);
+                if (i % 3 == 0) {
+                    shared.deallocate(mine.back());
+                    mine.pop_back();
+                }
+            }
+            for (PoolNode* node : mine) {
+                if (node->key != t) {
+                    failures++;
+                }
+                shared.deallocate(node);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    assert(failures.load() == 0);
+    assert(shared.size() == 0);
+    
+    std::cout << "✓ Typed object pool works correctly" << std::endl;
+}
+
+void test_arena_heap() {
+    std::cout << "Testing size-class arena heap..." << std::endl;
+    
+    MemoryArena arena(4 * 1024 * 1024);
+    ArenaHeap heap(arena, 8);
+    
+    // Mixed sizes and alignments
+    void* small = heap.allocate(1);
+    void* medium = heap.allocate(200);
+    void* aligned = heap.allocate(24, 64);
+    void* large = heap.allocate(100 * 1024);
+    assert(small && medium && aligned && large);
+    assert(reinterpret_cast<uintptr_t>(small) % alignof(std::max_align_t) == 0);
+    assert(reinterpret_cast<uintptr_t>(aligned) % 64 == 0);
+    assert(ArenaHeap::usable_size(medium) >= 200);
+    assert(ArenaHeap::usable_size(large) >= 100 * 1024);
+    std::memset(medium, 0x5A, 200);
+    std::memset(large, 0x5A, 100 * 1024);
+    assert(heap.allocate(16, 3) == nullptr);
+    
+    // Frees in any order are reused without touching the arena
+    heap.free(medium);
+    heap.free(small);
+    heap.free(large);
+    size_t before = arena.remaining();
+    void* medium_again = heap.allocate(180);
+    void* large_again = heap.allocate(90 * 1024);
+    assert(medium_again == medium);
+    assert(large_again == large);
+    assert(arena.remaining() == before);
+    heap.free(aligned);
+    heap.free(nullptr);
+    
+    // Per-thread caches with batched return to the shared lists
+    std::vector<std::thread> threads;
+    std::atomic<int> failures{0};
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t]() {
+            ArenaHeap::ThreadCache cache(heap);
+            std::vector<std::pair<unsigned char*, size_t>> live;
+            for (int i = 0; i < 2000; ++i) {
+                size_t size = 8 + (i * 37 + t * 11) % 2000;
+                unsigned char* ptr = static_cast<unsigned char*>(cache.allocate(size));
+                if (!ptr) {
+                    failures++;
+                    continue;
+                }
+                std::memset(ptr, t, size);
+                live.emplace_back(ptr, size);
+                if (i % 3 != 0) {
+                    auto victim = live[(i * 7) % live.size()];
+                    for (size_t b = 0; b < victim.second; ++b) {
+                        if (victim.first[b] != static_cast<unsigned char>(t)) {
+                            failures++;
+                            break;
+                        }
+                    }
+                    cache.free(victim.first);
+                    live[(i * 7) % live.size()] = live.back();
+                    live.pop_back();
+                }
+            }
+            for (auto& entry : live) {
+                cache.free(entry.first);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    assert(failures.load() == 0);
+    
+    // Arena reset invalidates the heap wholesale
+    arena.reset();
+    void* fresh = heap.allocate(64);
+    assert(fresh != nullptr);
+    heap.free(fresh);
+    
+    // A block from before the reset freed into a cache is not handed out again
+    {
+        MemoryArena scratch(1 << 20);
+        ArenaHeap scratch_heap(scratch, 8);
+        ArenaHeap::ThreadCache cache(scratch_heap);
+        char* stale = static_cast<char*>(cache.allocate(64));
+        assert(stale);
+        scratch.reset();
+        const size_t data_size = 64 * 1024;
+        char* data = scratch.allocate_array<char>(data_size);
+        assert(data && stale >= data && stale < data + data_size);
+        std::memset(data, 0x77, data_size);
+        cache.free(stale);
+        char* next = static_cast<char*>(cache.allocate(64));
+        assert(next && (next >= data + data_size || next + 64 <= data));
+        std::memset(next, 0, 64);
+        for (size_t i = 0; i < data_size; ++i) {
+            assert(data[i] == 0x77);
+        }
+        cache.free(next);
+    }
+    
+    std::cout << "✓ Arena heap works correctly" << std::endl;
+}
+
+void test_arena_stats() {
+    std::cout << "Testing allocation statistics..." << std::endl;
+    
+    static_assert(MemoryArena::stats_enabled, "tests build with ARENA_ENABLE_STATS");
+    MemoryArena arena(4096);
+    ArenaStats initial = arena.stats();
+    assert(initial.allocations == 0 && initial.in_use == 0 && initial.peak_usage == 0);
+    
+    // One byte, then an aligned struct forces padding
+    char* byte = arena.allocate<char>();
+    AlignedStruct* aligned = arena.allocate<AlignedStruct>();
+    assert(byte && aligned);
+    ArenaStats stats = arena.stats();
+    assert(stats.allocations == 2);
+    assert(stats.bytes_allocated == 1 + sizeof(AlignedStruct));
+    assert(stats.padding_bytes == 15);
+    assert(stats.in_use == 16 + sizeof(AlignedStruct));
+    assert(stats.peak_usage == stats.in_use);
+    assert(stats.size_buckets[arena_stats_bucket(1)] == 1);
+    assert(stats.size_buckets[arena_stats_bucket(sizeof(AlignedStruct))] == 1);
+    
+    // Releasing from the top lowers usage but keeps the high-water mark
+    arena.deallocate(aligned);
+    stats = arena.stats();
+    assert(stats.in_use == 16);
+    assert(stats.peak_usage == 16 + sizeof(AlignedStruct));
+    
+    // In-place growth counts as bytes, not as another allocation
+    void* record = arena.allocate_bytes(64, 16);
+    assert(arena.try_extend(record, 64, 256));
+    stats = arena.stats();
+    assert(stats.allocations == 3);
+    assert(stats.in_use == 16 + 256);
+    assert(stats.peak_usage == 16 + 256);
+    
+    // Rewind restores usage to the marker
+    MemoryArena::Marker marker = arena.mark();
+    arena.allocate_array<int>(100);
+    assert(arena.stats().in_use > 16 + 256);
+    arena.rewind(marker);
+    assert(arena.stats().in_use == 16 + 256);
+    
+    // Failures are counted, and reset() clears usage and peak
+    assert(arena.allocate_bytes(8192) == nullptr);
+    stats = arena.stats();
+    assert(stats.failed_allocations == 1);
+    arena.reset();
+    stats = arena.stats();
+    assert(stats.reset_count == 1);
+    assert(stats.in_use == 0 && stats.peak_usage == 0);
+    assert(stats.allocations == 4 && stats.failed_allocations == 1);
+    
+    // Buckets are powers of four, the last one open-ended
+    assert(arena_stats_bucket(0) == 0 && arena_stats_bucket(15) == 0);
+    assert(arena_stats_bucket(16) == 1 && arena_stats_bucket(63) == 1);
+    assert(arena_stats_bucket(64) == 2);
+    assert(arena_stats_bucket(SIZE_MAX) == arena_stats_bucket_count - 1);
+    
+    // Concurrent lock-free bumps add up exactly
+    MemoryArena shared(1024 * 1024, ArenaFlags::LockFree);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < 1000; ++i) {
+                shared.allocate<uint64_t>();
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    stats = shared.stats();
+    assert(stats.allocations == 4000);
+    assert(stats.in_use == 4000 * sizeof(uint64_t));
+    assert(stats.peak_usage == stats.in_use);
+    
+    std::cout << "✓ Allocation statistics work correctly" << std::endl;
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((noinline))
+#endif
+static void allocate_from_three_calls(MemoryArena& arena) {
+    arena.allocate_bytes(8);
+    arena.allocate<int>();
+    arena.allocate_array<int>(3);
+    std::atomic_signal_fence(std::memory_order_seq_cst);  // no tail call
+}
+
+void test_allocation_tracing() {
+    std::cout << "Testing allocation hooks and trace export..." << std::endl;
+    
+    static_assert(MemoryArena::hooks_enabled, "tests build with ARENA_ENABLE_HOOKS");
+    MemoryArena arena(1024);
+    
+    // A plain hook sees every allocation, failure and reset
+    struct Counts { int allocations = 0; int failures = 0; int resets = 0; size_t bytes = 0; } counts;
+    ArenaHooks hooks;
+    hooks.context = &counts;
+    hooks.on_event = [](void* context, const void*, ArenaEvent event, const void*, size_t size,
+                        size_t, const void*) {
+        Counts* c = static_cast<Counts*>(context);
+        if (event == ArenaEvent::Allocate) { c->allocations++; c->bytes += size; }
+        if (event == ArenaEvent::Failure) c->failures++;
+        if (event == ArenaEvent::Reset) c->resets++;
+    };
+    arena.set_hooks(&hooks);
+    arena.allocate<int>();
+    arena.allocate_array<double>(4);
+    arena.allocate_bytes(100);
+    arena.allocate_array_uninit<char>(10);
+    assert(arena.allocate_bytes(4096) == nullptr);
+    arena.reset();
+    assert(counts.allocations == 4 && counts.failures == 1 && counts.resets == 1);
+    assert(counts.bytes == sizeof(int) + 4 * sizeof(double) + 100 + 10);
+    arena.set_hooks(nullptr);
+    arena.allocate<int>();
+    assert(counts.allocations == 4);
+    
+    // Each call reports its own site inside the caller, at any -O level
+    const void* sites[3] = {};
+    int site_count = 0;
+    struct SiteLog { const void** sites; int* count; } log{sites, &site_count};
+    ArenaHooks site_hooks;
+    site_hooks.context = &log;
+    site_hooks.on_event = [](void* context, const void*, ArenaEvent, const void*, size_t, size_t,
+                             const void* call_site) {
+        SiteLog* l = static_cast<SiteLog*>(context);
+        if (*l->count < 3) l->sites[(*l->count)++] = call_site;
+    };
+    arena.set_hooks(&site_hooks);
+    allocate_from_three_calls(arena);
+    arena.set_hooks(nullptr);
+    assert(site_count == 3 && sites[0] != sites[1] && sites[1] != sites[2]);
+    const char* caller = reinterpret_cast<const char*>(&allocate_from_three_calls);
+    for (const void* site : sites) {
+        assert(static_cast<const char*>(site) > caller && static_cast<const char*>(site) < caller + 4096);
+    }
+
+    // Front-ends over the arena raise events too, one per request they serve
+    MemoryArena front(64 * 1024);
+    Counts front_counts;
+    ArenaHooks front_hooks;
+    front_hooks.context = &front_counts;
+    front_hooks.on_event = hooks.on_event;
+    front.set_hooks(&front_hooks);
+    {
+        std::vector<int, ArenaAllocator<int>> values{ArenaAllocator<int>(front)};
+        for (int i = 0; i < 100; ++i) {
+            values.push_back(i);
+        }
+        assert(front_counts.allocations > 0 && front_counts.bytes >= 100 * sizeof(int));
+    }
+    front_counts = Counts();
+    ThreadLocalArena local(front, 1024);
+    local.allocate<int>();
+    local.allocate_array<double>(3);
+    TypedPool<double> pool(front, 4);
+    pool.deallocate(pool.allocate(1.0));
+    ArenaHeap heap(front);
+    heap.free(heap.allocate(40));
+    ArenaHeap::ThreadCache cache(heap);
+    cache.free(cache.allocate(40));
+    assert(front_counts.allocations == 5);
+    assert(front_counts.bytes == sizeof(int) + 3 * sizeof(double) + sizeof(double) + 40 + 40);
+    front.set_hooks(nullptr);
+
+    // The recorder keeps labels, sizes and the newest events when it wraps
+    ArenaTraceRecorder recorder(8);
+    assert(recorder.capacity() == 8);
+    recorder.attach(arena);
+    {
+        ArenaTraceLabel request("handle_request");
+        arena.allocate_bytes(64);
+        {
+            ArenaTraceLabel parse("parse \"body\"");
+            arena.allocate_array<int>(16);
+            arena.allocate_bytes(2048);
+        }
+    }
+    arena.reset();
+    std::vector<ArenaTraceRecorder::Event> events = recorder.snapshot();
+    assert(events.size() == 4);
+    assert(events[0].kind == ArenaEvent::Allocate && events[0].size == 64);
+    assert(events[0].label_depth == 1 && std::string(events[0].labels[0]) == "handle_request");
+    assert(events[1].label_depth == 2 && events[1].size == 16 * sizeof(int));
+    assert(events[2].kind == ArenaEvent::Failure && events[2].ptr == nullptr);
+    assert(events[3].kind == ArenaEvent::Reset);
+    assert(events[0].timestamp_ns <= events[3].timestamp_ns);
+    
+    std::ostringstream folded;
+    recorder.write_folded_stacks(folded);
+    std::string folded_text = folded.str();
+    assert(folded_text.find("handle_request;0x") == 0 || folded_text.find("\nhandle_request;0x") != std::string::npos);
+    assert(folded_text.find(" 64\n") != std::string::npos);
+    assert(folded_text.find(";[failed] 2048\n") != std::string::npos);
+    
+    std::ostringstream chrome;
+    recorder.write_chrome_trace(chrome);
+    std::string trace = chrome.str();
+    assert(trace.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[") == 0);
+    assert(trace.find("\"name\":\"parse \\\"body\\\"\"") != std::string::npos);
+    assert(trace.find("\"name\":\"reset\"") != std::string::npos);
+    assert(trace.find("\"failed\":true") != std::string::npos);
+    
+    for (int i = 0; i < 20; ++i) {
+        arena.allocate<int>();
+    }
+    assert(recorder.size() == 8);
+    assert(recorder.dropped() == 24 - 8);
+    recorder.clear();
+    assert(recorder.size() == 0);
+    recorder.detach(arena);
+    
+    std::cout << "✓ Allocation hooks and trace export work correctly" << std::endl;
+}
+
+void test_generational_arena() {
+    std::cout << "Testing generational arena rotation..." << std::endl;
+    
+    GenerationalArena arenas(4096, 1);
+    assert(arenas.generations() == 2);
+    assert(arenas.generation() == 0);
+    
+    // Generation 0 stays readable while generation 1 fills
+    GenerationalArena::Pin batch0 = arenas.pin();
+    int* value0 = batch0.arena().allocate<int>();
+    *value0 = 100;
+    assert(arenas.try_advance());
+    assert(arenas.generation() == 1);
+    GenerationalArena::Pin batch1 = arenas.pin();
+    assert(batch1.generation() == 1);
+    assert(&batch1.arena() != &batch0.arena());
+    int* value1 = batch1.arena().allocate<int>();
+    *value1 = 200;
+    
+    // Recycling generation 0's arena waits for its pin
+    assert(!arenas.try_advance());
+    assert(arenas.generation() == 1);
+    assert(*value0 == 100);
+    GenerationalArena::Pin shared = batch0;
+    batch0.release();
+    assert(!batch0);
+    assert(!arenas.try_advance());
+    shared = GenerationalArena::Pin();
+    size_t before = arenas.current().remaining();
+    batch1.release();
+    assert(arenas.try_advance());
+    assert(arenas.generation() == 2);
+    assert(arenas.current().remaining() == 4096);
+    assert(before < 4096);
+    
+    // Producer and consumer pipelined across threads
+    struct Batch {
+        GenerationalArena::Pin pin;
+        int* values;
+        int round;
+    };
+    GenerationalArena pipeline(64 * 1024, 3);
+    std::atomic<int> mismatches{0};
+    std::atomic<long> consumed{0};
+    std::vector<Batch> queue;
+    std::mutex queue_mutex;
+    std::atomic<bool> done{false};
+    std::thread consumer([&]() {
+        for (;;) {
+            Batch batch{};
+            bool finished = done.load();
+            {
+                std::lock_guard<std::mutex> lock(queue_mutex);
+                if (!queue.empty()) {
+                    batch = std::move(queue.front());
+                    queue.erase(queue.begin());
+                }
+            }
+            if (!batch.pin) {
+                if (finished) break;
+                std::this_thread::yield();
+                continue;
+            }
+            for (int i = 0; i < 256; ++i) {
+                if (batch.values[i] != batch.round) mismatches++;
+            }
+            consumed++;
+        }
+    });
+    for (int round = 0; round < 50; ++round) {
+        GenerationalArena::Pin pin = pipeline.pin();
+        int* values = pin.arena().allocate_array<int>(256);
+        assert(values != nullptr);
+        for (int i = 0; i < 256; ++i) values[i] = round;
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            queue.push_back(Batch{std::move(pin), values, round});
+        }
+        pipeline.advance();
+    }
+    done = true;
+    consumer.join();
+    assert(mismatches.load() == 0);
+    assert(consumed.load() == 50);
+    assert(pipeline.generation() == 50);
+    
+    std::cout << "✓ Generational arena works correctly" << std::endl;
+}
+
+void test_arena_policies() {
+    std::cout << "Testing compile-time arena policies..." << std::endl;
+    
+    static_assert(std::is_same_v<MemoryArena, BasicArena<MutexLock, CountingStats>>,
+                  "MemoryArena is the default configuration");
+    using LocalArena = BasicArena<NullLock, NoStats>;
+    static_assert(!LocalArena::stats_enabled, "NoStats compiles the counters out");
+    static_assert(sizeof(LocalArena) < sizeof(MemoryArena), "no mutex and no counters");
+    
+    // Same API without a lock, including growth, scopes and finalizers
+    ArenaOptions options;
+    options.growth = GrowthPolicy::Geometric;
+    LocalArena local(256, options);
+    assert(!local.is_lock_free());
+    int* first = local.allocate<int>();
+    assert(first && *first == 0);
+    {
+        ArenaScope scope(local);
+        TestObject* object = local.allocate<TestObject>();
+        assert(object && object->value == 42);
+        double* big = local.allocate_array<double>(100);
+        assert(big != nullptr);
+        assert(local.usage().block_count == 2);
+    }
+    assert(local.stats().allocations == 0);
+    char* bytes = static_cast<char*>(local.allocate_bytes(10));
+    assert(local.try_extend(bytes, 10, 20));
+    local.reset();
+    assert(local.remaining() >= 256);
+    
+    // Stats without a lock
+    BasicArena<NullLock, CountingStats> counted(1024);
+    counted.allocate_array<char>(100);
+    assert(counted.stats().allocations == 1);
+    assert(counted.stats().bytes_allocated == 100);
+    
+    std::cout << "✓ Compile-time arena policies work correctly" << std::endl;
+}
+
+void test_static_arena() {
+    std::cout << "Testing inline-buffer arena with heap fallback..." << std::endl;
+    
+    StaticArena<4096> arena;
+    assert(arena.usage().block_count == 1);
+    size_t inline_bytes = arena.remaining();
+    assert(inline_bytes < 4096 && inline_bytes > 4096 - 128);
+    
+    // Small allocations stay inside the object
+    int* numbers = arena.allocate_array<int>(64);
+    TestObject* object = arena.allocate<TestObject>();
+    assert(numbers && object);
+    assert(arena.is_inline(numbers) && arena.is_inline(object));
+    assert(object->value == 42);
+    
+    // Overflow chains a heap block
+    char* big = arena.allocate_array<char>(8000);
+    assert(big != nullptr);
+    assert(!arena.is_inline(big));
+    assert(arena.usage().block_count == 2);
+    std::memset(big, 1, 8000);
+    
+    // reset() goes back to the inline buffer and keeps the heap block as a spare
+    arena.reset();
+    assert(arena.usage().block_count == 2);
+    int* again = arena.allocate<int>();
+    assert(arena.is_inline(again));
+    assert(arena.remaining() >= inline_bytes - sizeof(int) + 8000);
+    char* reused = arena.allocate_array<char>(8000);
+    assert(reused == big);
+    arena.reset();
+    
+    // Fixed growth turns the inline buffer into a hard cap
+    StaticArena<512, NullLock> fixed{ArenaOptions{}};
+    assert(fixed.allocate_bytes(1024) == nullptr);
+    void* fits = fixed.allocate_bytes(128);
+    assert(fits && fixed.is_inline(fits));
+    {
+        ArenaScope scope(fixed);
+        fixed.allocate_bytes(200);
+    }
+    assert(fixed.allocate_bytes(200) != nullptr);
+    static_assert(sizeof(StaticArena<512, NullLock>) >= 512, "buffer is inline");
+    
+    // A caller-owned buffer works the same way
+    alignas(std::max_align_t) static char buffer[1024];
+    MemoryArena borrowed(buffer, sizeof(buffer), StaticArena<1024>::default_options());
+    char* inside = borrowed.allocate_array<char>(100);
+    assert(inside >= buffer && inside < buffer + sizeof(buffer));
+    bool threw = false;
+    try {
+        MemoryArena tiny(buffer, 8, ArenaOptions{});
+    } catch (const std::bad_alloc&) {
+        threw = true;
+    }
+    assert(threw);
+    
+    std::cout << "✓ Inline-buffer arena works correctly" << std::endl;
+}
+
+void test_allocate_many() {
+    std::cout << "Testing batched multi-allocation..." << std::endl;
+    
+    struct RequestHeader {
+        uint32_t id;
+        uint32_t flags;
+    };
+    
+    MemoryArena arena(64 * 1024);
+    size_t before = arena.remaining();
+    auto [header, offsets, aligned, name] = arena.allocate_many<RequestHeader, uint32_t, AlignedStruct, std::string>(1, 100, 3, 2);
+    assert(header && offsets && aligned && name);
+    assert(reinterpret_cast<uintptr_t>(aligned) % alignof(AlignedStruct) == 0);
+    assert(header->id == 0 && offsets[99] == 0 && aligned[2].a == 0.0);
+    assert(name[0].empty() && name[1].empty());
+    name[1] = "a string long enough to need its own heap buffer";
+    
+    // Packed next to each other, in order
+    char* first = reinterpret_cast<char*>(header);
+    assert(reinterpret_cast<char*>(offsets) >= first + sizeof(RequestHeader));
+    assert(reinterpret_cast<char*>(aligned) >= reinterpret_cast<char*>(offsets + 100));
+    assert(reinterpret_cast<char*>(name) > reinterpret_cast<char*>(aligned + 3));
+    assert(before - arena.remaining() < 2048);
+    
+    // One bump for the whole group
+    assert(arena.stats().allocations == 1);
+    
+    // Zero counts yield nullptr, failures yield all nullptr
+    auto [none, some] = arena.allocate_many<double, char>(0, 10);
+    assert(none == nullptr && some != nullptr);
+    auto [huge, small] = arena.allocate_many<char, int>(1024 * 1024, 1);
+    assert(huge == nullptr && small == nullptr);
+    auto [overflow] = arena.allocate_many<uint64_t>(SIZE_MAX / 4);
+    assert(overflow == nullptr);
+    
+    // Destructors of non-trivial slots run on reset
+    TestObject::reset_counters();
+    auto [objects, ids] = arena.allocate_many<TestObject, int>(3, 3);
+    assert(objects && ids);
+    assert(TestObject::constructor_count == 3);
+    arena.reset();
+    assert(TestObject::destructor_count == 3);
+    
+    std::cout << "✓ Batched multi-allocation works correctly" << std::endl;
+}
+
+void test_epoch_protected_reset() {
+    std::cout << "Testing epoch-protected reset..." << std::endl;
+    
+    // Without the flag guards are empty and free
+    MemoryArena plain(1024);
+    assert(!plain.is_epoch_protected());
+    {
+        auto guard = plain.enter();
+        plain.reset();
+    }
+    
+    ArenaOptions options;
+    options.flags = ArenaFlags::EpochProtected | ArenaFlags::LockFree;
+    MemoryArena arena(64 * 1024, options);
+    assert(arena.is_epoch_protected());
+    
+    // Writers fill what they allocate and check it before leaving; a reset
+    // that rewound under them would let another writer overwrite the block.
+    std::atomic<bool> stop{false};
+    std::atomic<int> corrupted{0};
+    std::atomic<long> checked{0};
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 3; ++t) {
+        writers.emplace_back([&, t]() {
+            unsigned char pattern = static_cast<unsigned char>(t + 1);
+            while (!stop.load()) {
+                auto guard = arena.enter();
+                unsigned char* data = static_cast<unsigned char*>(arena.allocate_bytes(256));
+                if (!data) {
+                    continue;
+                }
+                std::memset(data, pattern, 256);
+                std::this_thread::yield();
+                for (int i = 0; i < 256; ++i) {
+                    if (data[i] != pattern) {
+                        corrupted++;
+                        break;
+                    }
+                }
+                checked++;
+            }
+        });
+    }
+    std::thread resetter([&]() {
+        while (!stop.load()) {
+            arena.reset();
+            std::this_thread::yield();
+        }
+    });
+    
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    stop = true;
+    for (auto& w : writers) {
+        w.join();
+    }
+    resetter.join();
+    assert(corrupted.load() == 0);
+    assert(checked.load() > 0);
+    
+    // Moving and leaving a guard early lets reset proceed
+    auto guard = arena.enter();
+    auto moved = std::move(guard);
+    moved.leave();
+    arena.reset();
+    assert(arena.remaining() == 64 * 1024);
+    
+    std::cout << "✓ Epoch-protected reset works correctly (" << checked.load() << " checked writes)" << std::endl;
+}
+
+void test_arena_soa() {
+    std::cout << "Testing structure-of-arrays container..." << std::endl;
+    
+    MemoryArena arena(1024 * 1024);
+    ArenaSoA<float, uint32_t, uint8_t> table(arena, 100);
+    assert(table.capacity() == 100 && table.size() == 0);
+    
+    // Columns are 64-byte aligned and disjoint
+    float* prices = table.column<0>();
+    uint32_t* ids = table.column<1>();
+    uint8_t* flags = table.column<2>();
+    assert(reinterpret_cast<uintptr_t>(prices) % 64 == 0);
+    assert(reinterpret_cast<uintptr_t>(ids) % 64 == 0);
+    assert(reinterpret_cast<uintptr_t>(flags) % 64 == 0);
+    assert(reinterpret_cast<char*>(ids) >= reinterpret_cast<char*>(prices + 100));
+    
+    for (uint32_t i = 0; i < 100; ++i) {
+        assert(table.push_back(i * 0.5f, i, static_cast<uint8_t>(i % 2)));
+    }
+    assert(table.size() == 100);
+    
+    // Growth keeps existing rows and moves the columns
+    assert(table.push_back(50.0f, 100, 1));
+    assert(table.capacity() == 200);
+    assert(table.column<1>()[100] == 100);
+    assert(table.at<0>(10) == 5.0f);
+    
+    // Bulk append from one array per field
+    std::vector<float> more_prices(1000, 2.0f);
+    std::vector<uint32_t> more_ids(1000, 7);
+    std::vector<uint8_t> more_flags(1000, 1);
+    assert(table.append(1000, more_prices.data(), more_ids.data(), more_flags.data()));
+    assert(table.size() == 1101);
+    
+    // A filtering kernel over two columns
+    float total = 0;
+    const float* p = table.column<0>();
+    const uint8_t* f = table.column<2>();
+    for (size_t i = 0; i < table.size(); ++i) {
+        total += f[i] ? p[i] : 0.0f;
+    }
+    float expected = 50.0f + 2000.0f;
+    for (uint32_t i = 1; i < 100; i += 2) {
+        expected += i * 0.5f;
+    }
+    assert(total == expected);
+    
+    // Failure leaves the table intact, a reset empties it
+    MemoryArena small(4096);
+    ArenaSoA<double, double> tight(small, 100);
+    assert(tight.capacity() == 100);
+    assert(tight.push_back(1.0, 2.0));
+    assert(!tight.reserve(1000));
+    assert(tight.size() == 1 && tight.at<1>(0) == 2.0);
+    small.reset();
+    assert(tight.size() == 0 && tight.capacity() == 0);
+    assert(tight.push_back(3.0, 4.0));
+    assert(tight.at<0>(0) == 3.0);
+    
+    std::cout << "✓ Structure-of-arrays container works correctly" << std::endl;
+}
+
+void test_arena_flat_map() {
+    std::cout << "Testing arena flat map and string interner..." << std::endl;
+    
+    MemoryArena arena(4 * 1024 * 1024);
+    ArenaFlatMap<uint64_t, uint64_t> map(arena);
+    assert(map.size() == 0 && map.find(1) == nullptr);
+    
+    // Insert enough keys to force several rehashes, then check every one
+    for (uint64_t i = 0; i < 10000; ++i) {
+        auto [value, inserted] = map.try_emplace(i * 7919, i);
+        assert(value && inserted && *value == i);
+    }
+    assert(map.size() == 10000);
+    assert(map.capacity() * 7 >= map.size() * 8);
+    for (uint64_t i = 0; i < 10000; ++i) {
+        uint64_t* value = map.find(i * 7919);
+        assert(value && *value == i);
+    }
+    assert(!map.contains(1));
+    auto [existing, inserted] = map.try_emplace(7919, 99);
+    assert(!inserted && *existing == 1);
+    
+    // Erase leaves tombstones that lookups skip and inserts reuse
+    for (uint64_t i = 0; i < 10000; i += 2) {
+        assert(map.erase(i * 7919));
+    }
+    assert(!map.erase(0));
+    assert(map.size() == 5000);
+    for (uint64_t i = 0; i < 10000; ++i) {
+        assert(map.contains(i * 7919) == (i % 2 == 1));
+    }
+    size_t capacity = map.capacity();
+    for (uint64_t i = 0; i < 10000; i += 2) {
+        map.try_emplace(i * 7919, i);
+    }
+    assert(map.size() == 10000 && map.capacity() == capacity);
+    uint64_t sum = 0;
+    map.for_each([&](uint64_t, uint64_t& value) { sum += value; });
+    assert(sum == 10000ull * 9999 / 2);
+    
+    // Non-trivial values are destroyed on erase, clear and rehash
+    {
+        ArenaFlatMap<int, std::string> names(arena, 4);
+        names.try_emplace(1, "one");
+        names.try_emplace(2, std::string(100, 'x'));
+        for (int i = 3; i < 100; ++i) names.try_emplace(i, "n");
+        assert(*names.find(2) == std::string(100, 'x'));
+        names.erase(1);
+        names.clear();
+        assert(names.size() == 0 && names.find(2) == nullptr);
+    }
+    
+    // Out of memory is reported, not thrown
+    MemoryArena tiny(1024);
+    ArenaFlatMap<int, int> bounded(tiny);
+    bool failed = false;
+    for (int i = 0; i < 1000 && !failed; ++i) {
+        failed = bounded.try_emplace(i, i).first == nullptr;
+    }
+    assert(failed);
+    
+    // Interner keeps one copy per distinct string, inside the arena
+    ArenaStringInterner interner(arena, 64);
+    std::string_view a = interner.intern("alpha");
+    std::string owned = "alpha";
+    std::string_view b = interner.intern(owned);
+    assert(a.data() == b.data() && a == "alpha");
+    uint32_t beta = interner.intern_id("beta");
+    assert(interner.lookup(beta) == "beta");
+    assert(interner.find("alpha") == interner.find(a));
+    assert(interner.find("gamma") == ArenaStringInterner::npos);
+    std::string long_text(500, 'z');
+    std::string_view stored = interner.intern(long_text);
+    assert(stored == long_text && stored.data() != long_text.data());
+    for (int i = 0; i < 2000; ++i) {
+        interner.intern("key" + std::to_string(i % 500));
+    }
+    assert(interner.size() == 3 + 500);
+    assert(interner.intern("").empty());
+    assert(interner.lookup(interner.find("key42")) == "key42");
+    
+    // reset() frees everything at once
+    arena.reset();
+    assert(map.size() == 0 && interner.size() == 0);
+    assert(interner.find("alpha") == ArenaStringInterner::npos);
+    assert(interner.intern("alpha") == "alpha");
+    
+    std::cout << "✓ Arena flat map and string interner work correctly" << std::endl;
+}
+
+struct SnapshotNode {
+    uint64_t key;
+    arena_offset_ptr<SnapshotNode> next;
+    arena_offset_ptr<char> name;
+};
+
+struct SnapshotRoot {
+    arena_offset_ptr<SnapshotNode> first;
+    uint32_t count;
+    alignas(64) double table[8];
+};
+
+void test_arena_snapshot() {
+    std::cout << "Testing arena snapshot and reload..." << std::endl;
+    
+    const char* path = "/tmp/arena_snapshot_test.bin";
+    
+    // Offset pointers follow a copy of the bytes to another address
+    static_assert(std::is_trivially_destructible_v<arena_offset_ptr<int>>, "no finalizer needed");
+    alignas(16) char source[64];
+    alignas(16) char copy[64];
+    int* target = reinterpret_cast<int*>(source + 32);
+    *target = 5;
+    arena_offset_ptr<int>* link = new (source) arena_offset_ptr<int>(target);
+    assert(link->get() == target && **link == 5);
+    std::memcpy(copy, source, sizeof(source));
+    assert(reinterpret_cast<arena_offset_ptr<int>*>(copy)->get() == reinterpret_cast<int*>(copy + 32));
+    arena_offset_ptr<int> empty;
+    assert(!empty && empty.get() == nullptr);
+    
+    // Build a linked structure and save it
+    void* loaded_root = nullptr;
+    {
+        MemoryArena arena(64 * 1024);
+        SnapshotRoot* root = arena.allocate<SnapshotRoot>();
+        SnapshotNode* previous = nullptr;
+        for (uint64_t i = 0; i < 100; ++i) {
+            SnapshotNode* node = arena.allocate<SnapshotNode>();
+            assert(node);
+            node->key = i * i;
+            char* name = arena.allocate_array<char>(8);
+            assert(name);
+            std::snprintf(name, 8, "n%llu", static_cast<unsigned long long>(i));
+            node->name = name;
+            if (previous) {
+                previous->next = node;
+            } else {
+                root->first = node;
+            }
+            previous = node;
+        }
+        root->count = 100;
+        for (int i = 0; i < 8; ++i) root->table[i] = i * 1.5;
+        assert(!ArenaSnapshot::save(arena, path, &arena));
+        assert(ArenaSnapshot::save(arena, path, root));
+        std::memset(static_cast<void*>(root), 0, sizeof(SnapshotRoot));
+    }
+    
+    // Reload at a different address and walk it
+    std::unique_ptr<MemoryArena> loaded = ArenaSnapshot::load(path, &loaded_root);
+    assert(loaded && loaded_root);
+    SnapshotRoot* root = static_cast<SnapshotRoot*>(loaded_root);
+    assert(reinterpret_cast<uintptr_t>(root->table) % 64 == 0);
+    assert(root->count == 100 && root->table[7] == 7 * 1.5);
+    uint64_t visited = 0;
+    for (SnapshotNode* node = root->first.get(); node; node = node->next.get()) {
+        assert(node->key == visited * visited);
+        assert(std::string(node->name.get()) == "n" + std::to_string(visited));
+        visited++;
+    }
+    assert(visited == 100);
+    
+    // The loaded arena is full; new allocations chain a block, reset reuses the mapping
+    assert(loaded->remaining_in_block() == 0);
+    assert(loaded->allocate<int>() == nullptr);
+    ArenaOptions growing;
+    growing.growth = GrowthPolicy::Linear;
+    growing.block_size = 4096;
+    std::unique_ptr<MemoryArena> extended = ArenaSnapshot::load(path, nullptr, growing);
+    assert(extended && extended->allocate<int>() != nullptr);
+    assert(extended->usage().block_count == 2);
+    extended->reset();
+    assert(extended->allocate_array<char>(1000) != nullptr);
+    
+    // Multi-block arenas, finalizers and bad files are refused
+    ArenaOptions chained;
+    chained.growth = GrowthPolicy::Linear;
+    MemoryArena multi(256, chained);
+    multi.allocate_array<char>(200);
+    multi.allocate_array<char>(200);
+    assert(!ArenaSnapshot::save(multi, path));
+    MemoryArena with_strings(4096);
+    with_strings.allocate<std::string>();
+    assert(!ArenaSnapshot::save(with_strings, path));
+    MemoryArena unused(4096);
+    assert(!ArenaSnapshot::save(unused, path));
+    assert(!ArenaSnapshot::load("/nonexistent/arena.bin"));
+    std::FILE* garbage = std::fopen(path, "wb");
+    std::fputs("not a snapshot", garbage);
+    std::fclose(garbage);
+    assert(!ArenaSnapshot::load(path));
+    std::remove(path);
+    
+    std::cout << "✓ Arena snapshot and reload work correctly" << std::endl;
+}
+
+struct SharedEntry {
+    uint64_t key;
+    uint64_t value;
+    uint64_t next;   // offset of the next entry, 0 at the end
+};
+
+struct SharedTable {
+    std::atomic<uint64_t> head;
+    std::atomic<uint32_t> writers_done;
+};
+
+void test_shared_arena() {
+    std::cout << "\nTesting shared-memory arena across processes..." << std::endl;
+    
+    std::string name = "/arena-test-" + std::to_string(getpid());
+    SharedArena::unlink(name.c_str());
+    std::unique_ptr<SharedArena> arena = SharedArena::create(name.c_str(), 1 << 16);
+    assert(arena);
+    assert(!SharedArena::create(name.c_str(), 1 << 16));
+    assert(arena->capacity() >= (1 << 16));
+    assert(!arena->root<SharedTable>());
+    
+    SharedTable* table = arena->allocate<SharedTable>();
+    assert(table && arena->contains(table));
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    void* page_aligned = arena->allocate_bytes(1, page);
+    assert(page_aligned && reinterpret_cast<uintptr_t>(page_aligned) % page == 0);
+    size_t left = arena->remaining();
+    assert(!arena->allocate_bytes(1, page * 2) && arena->remaining() == left);
+    arena->set_root(table);
+    
+    // Children attach by name and push entries onto a list linked by
+    // offset, allocating from the same cursor as the parent
+    const int child_count = 3;
+    const uint64_t per_child = 100;
+    for (int c = 0; c < child_count; ++c) {
+        pid_t pid = fork();
+        assert(pid >= 0);
+        if (pid == 0) {
+            std::unique_ptr<SharedArena> attached = SharedArena::open(name.c_str());
+            if (!attached) _exit(1);
+            SharedTable* shared = attached->root<SharedTable>();
+            if (!shared) _exit(2);
+            for (uint64_t i = 0; i < per_child; ++i) {
+                SharedEntry* entry = attached->allocate<SharedEntry>();
+                if (!entry) _exit(3);
+                entry->key = static_cast<uint64_t>(c) * per_child + i;
+                entry->value = entry->key * 3;
+                uint64_t head = shared->head.load(std::memory_order_acquire);
+                do {
+                    entry->next = head;
+                } while (!shared->head.compare_exchange_weak(head, attached->offset_of(entry),
+                                                             std::memory_order_release, std::memory_order_acquire));
+            }
+            shared->writers_done.fetch_add(1, std::memory_order_release);
+            _exit(0);
+        }
+    }
+    for (int c = 0; c < child_count; ++c) {
+        int status = 0;
+        wait(&status);
+        assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+    
+    assert(table->writers_done.load() == child_count);
+    std::vector<bool> seen(child_count * per_child, false);
+    size_t entries = 0;
+    for (uint64_t offset = table->head.load(); offset; ) {
+        SharedEntry* entry = arena->at<SharedEntry>(offset);
+        assert(entry->key < seen.size() && !seen[entry->key]);
+        assert(entry->value == entry->key * 3);
+        seen[entry->key] = true;
+        offset = entry->next;
+        ++entries;
+    }
+    assert(entries == child_count * per_child);
+    
+    // A second attachment in this process maps elsewhere but sees the same data
+    std::unique_ptr<SharedArena> second = SharedArena::open(name.c_str());
+    assert(second && second->root<SharedTable>() != table);
+    assert(second->root<SharedTable>()->head.load() == table->head.load());
+    assert(second->remaining() == arena->remaining());
+    
+    // Exhaustion fails cleanly, reset starts over for every attachment
+    assert(!arena->allocate_bytes(arena->capacity() + 1));
+    while (arena->allocate_bytes(4096, 1)) {}
+    assert(second->remaining() < 4096);
+    second->reset();
+    assert(arena->remaining() == arena->capacity());
+    assert(arena->generation() == 1);
+    assert(!arena->root<SharedTable>());
+    
+    assert(SharedArena::unlink(name.c_str()));
+    assert(!SharedArena::open(name.c_str()));
+    assert(second->allocate<SharedEntry>() != nullptr);
+    
+    // Anonymous segments are shared through the descriptor
+    std::unique_ptr<SharedArena> anonymous = SharedArena::create_anonymous(4096);
+    if (anonymous) {
+        uint64_t* counter = anonymous->allocate<uint64_t>();
+        pid_t pid = fork();
+        assert(pid >= 0);
+        if (pid == 0) {
+            std::unique_ptr<SharedArena> inherited = SharedArena::open_fd(anonymous->fd());
+            if (!inherited) _exit(1);
+            *inherited->at<uint64_t>(anonymous->offset_of(counter)) = 42;
+            _exit(0);
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+        assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        assert(*counter == 42);
+    }
+    
+    std::cout << "✓ Shared-memory arena works across processes" << std::endl;
+}
+
+#if ARENA_HAS_COROUTINES
+arena_task<int> coroutine_fib(int n) {
+    if (n < 2) {
+        co_return n;
+    }
+    int a = co_await coroutine_fib(n - 1);
+    int b = co_await coroutine_fib(n - 2);
+    co_return a + b;
+}
+
+arena_task<std::string> coroutine_greet(std::string name) {
+    co_return "hello " + name;
+}
+
+arena_task<> coroutine_fail() {
+    throw std::runtime_error("handler failed");
+    co_return;
+}
+#endif
+
+void test_coroutine_frames() {
+    std::cout << "\nTesting coroutine frame allocation..." << std::endl;
+    
+#if ARENA_HAS_COROUTINES
+    MemoryArena arena(64 * 1024);
+    {
+        // Nested awaits complete in stack order, so every frame is popped
+        ArenaFrameScope scope(arena);
+        arena_task<int> task = coroutine_fib(15);
+        size_t started = arena.remaining();
+        assert(started < arena.usage().total_capacity);
+        assert(task.resume());
+        assert(task.result() == 610);
+        assert(arena.remaining() == started);
+    }
+    assert(arena.remaining() == arena.usage().total_capacity);
+    
+    // The innermost scope wins
+    MemoryArena request_arena(4096);
+    {
+        ArenaFrameScope scope(arena);
+        ArenaFrameScope request_scope(request_arena);
+        arena_task<std::string> greeting = coroutine_greet("arena");
+        assert(request_arena.remaining() < 4096);
+        assert(arena.remaining() == arena.usage().total_capacity);
+        greeting.resume();
+        assert(greeting.result() == "hello arena");
+    }
+    assert(request_arena.remaining() == 4096);
+    
+    // Out-of-order completion leaves earlier frames until reset
+    {
+        ArenaFrameScope scope(arena);
+        arena_task<int> first = coroutine_fib(3);
+        arena_task<int> second = coroutine_fib(4);
+        size_t both = arena.remaining();
+        first = arena_task<int>();
+        assert(arena.remaining() == both);
+        second.resume();
+        assert(second.result() == 3);
+    }
+    assert(arena.remaining() < arena.usage().total_capacity);
+    arena.reset();
+    
+    // Large frames are unmapped when freed, in any order
+    ArenaOptions large_options;
+    large_options.large_threshold = 64;
+    MemoryArena large_arena(64 * 1024, large_options);
+    {
+        ArenaFrameScope scope(large_arena);
+        arena_task<int> first = coroutine_fib(3);
+        arena_task<int> second = coroutine_fib(4);
+        size_t both = large_arena.usage().large_bytes;
+        assert(both > 0);
+        first = arena_task<int>();
+        assert(large_arena.usage().large_bytes < both);
+        second.resume();
+        assert(second.result() == 3);
+    }
+    assert(large_arena.usage().large_bytes == 0);
+    
+    // Without a scope frames come from the heap; exceptions reach the awaiter
+    arena_task<> failing = coroutine_fail();
+    failing.resume();
+    bool caught = false;
+    try {
+        failing.result();
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    assert(caught);
+    assert(arena.remaining() == arena.usage().total_capacity);
+    
+    std::cout << "✓ Coroutine frames are served from the arena" << std::endl;
+#else
+    std::cout << "- Coroutine frames NOT tested: rebuild with -std=c++20 to cover arena_task" << std::endl;
+#endif
+}
+
+void test_cache_line_isolation() {
+    std::cout << "\nTesting cache-line isolated allocation..." << std::endl;
+    
+    auto line_of = [](const void* p) { return reinterpret_cast<uintptr_t>(p) / arena_cache_line_size; };
+    auto on_line = [](const void* p) { return reinterpret_cast<uintptr_t>(p) % arena_cache_line_size == 0; };
+    
+    // Per-thread counters from allocate_isolated() never share a line
+    MemoryArena arena(64 * 1024);
+    const int num_threads = 4;
+    std::vector<std::atomic<uint64_t>*> counters(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+        counters[t] = arena.allocate_isolated<std::atomic<uint64_t>>();
+        assert(counters[t] && on_line(counters[t]));
+        assert(counters[t]->load() == 0);
+    }
+    int* neighbour = arena.allocate<int>();
+    for (int t = 0; t < num_threads; ++t) {
+        assert(line_of(neighbour) != line_of(counters[t]));
+        for (int u = 0; u < t; ++u) {
+            assert(line_of(counters[t]) != line_of(counters[u]));
+        }
+    }
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < 10000; ++i) {
+                counters[t]->fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int t = 0; t < num_threads; ++t) {
+        assert(counters[t]->load() == 10000);
+    }
+    
+    // Non-trivial objects keep their finalizer inside their own lines
+    TestObject::reset_counters();
+    TestObject* tracked = arena.allocate_isolated<TestObject>();
+    char* after = arena.allocate<char>();
+    assert(tracked && tracked->value == 42 && line_of(after) > line_of(tracked));
+    arena.reset();
+    assert(TestObject::destructor_count == 1);
+    
+    // The flag isolates every allocation, releases and extensions included
+    MemoryArena isolated(64 * 1024, ArenaFlags::CacheLineIsolated);
+    char* a = isolated.allocate<char>();
+    char* b = isolated.allocate<char>();
+    assert(on_line(a) && on_line(b) && b - a == static_cast<ptrdiff_t>(arena_cache_line_size));
+    size_t before = isolated.remaining();
+    void* bytes = isolated.allocate_bytes(100, 8);
+    assert(on_line(bytes) && isolated.remaining() == before - 2 * arena_cache_line_size);
+    assert(isolated.try_extend(bytes, 100, 120));
+    assert(isolated.remaining() == before - 2 * arena_cache_line_size);
+    assert(isolated.try_extend(bytes, 120, 0));
+    assert(isolated.remaining() == before);
+    // Freeing the newest non-trivial object pops its finalizer's lines too
+    struct LineWide { TestObject object; char pad[44]; };
+    TestObject::reset_counters();
+    LineWide* newest = isolated.allocate<LineWide>();
+    isolated.deallocate(newest);
+    assert(isolated.remaining() == before);
+    TestObject* newest_array = isolated.allocate_array<TestObject>(8);
+    isolated.deallocate_array(newest_array, 8);
+    assert(isolated.remaining() == before);
+    isolated.reset();
+    assert(TestObject::destructor_count == 9);
+    
+    // Hot objects come from their own region, cold ones from the blocks
+    ArenaOptions options;
+    options.hot_region_size = 4 * arena_cache_line_size;
+    MemoryArena split(64 * 1024, options);
+    size_t cold_before = split.remaining();
+    int* cold = split.allocate<int>();
+    uint64_t* hot = split.allocate_hot<uint64_t>();
+    assert(hot && on_line(hot) && split.hot_remaining() == 3 * arena_cache_line_size);
+    assert(split.remaining() == cold_before - sizeof(int));
+    assert(line_of(hot) != line_of(cold));
+    for (int i = 0; i < 3; ++i) {
+        assert(split.allocate_hot<uint64_t>());
+    }
+    assert(split.hot_remaining() == 0);
+    uint64_t* overflow = split.allocate_hot<uint64_t>();
+    assert(overflow && on_line(overflow) && split.remaining() < cold_before - sizeof(int));
+    split.reset();
+    assert(split.hot_remaining() == options.hot_region_size);
+    assert(split.allocate_hot<uint64_t>() == hot);
+    assert(arena.allocate_hot<int>() != nullptr);
+    
+    std::cout << "✓ Cache-line isolation keeps allocations on separate lines" << std::endl;
+}
+
+void test_large_allocation_bypass() {
+    std::cout << "\nTesting large-allocation bypass..." << std::endl;
+    
+    ArenaOptions options;
+    options.large_threshold = 64 * 1024;
+    MemoryArena arena(4096, options);
+    size_t before = arena.remaining();
+    
+    // A huge array goes to its own mapping and leaves the block untouched
+    const size_t big = 1 << 20;
+    char* huge = arena.allocate_array<char>(big);
+    assert(huge && huge[0] == 0 && huge[big - 1] == 0);
+    std::memset(huge, 0x5A, big);
+    assert(arena.remaining() == before);
+    assert(arena.usage().large_bytes >= big && arena.usage().block_count == 1);
+    int* small = arena.allocate<int>();
+    assert(small && arena.remaining() == before - sizeof(int));
+    
+    // Freed explicitly, the mapping goes away at once
+    arena.deallocate_array(huge, big);
+    assert(arena.usage().large_bytes == 0);
+    assert(arena.remaining() == before - sizeof(int));
+    void* bytes = arena.allocate_bytes(200 * 1024, 4096);
+    assert(bytes && reinterpret_cast<uintptr_t>(bytes) % 4096 == 0);
+    assert(arena.release_large(bytes));
+    assert(!arena.release_large(bytes) && !arena.release_large(small));
+    
+    // Non-trivial arrays are finalized; a node still on the stack keeps its mapping
+    std::string* top = arena.allocate_array<std::string>(4096);
+    assert(top && arena.usage().large_bytes > 0);
+    arena.deallocate_array(top, 4096);
+    assert(arena.usage().large_bytes == 0);
+    std::string* buried = arena.allocate_array<std::string>(4096);
+    buried[4095] = std::string(100, 'x');
+    std::string* later = arena.allocate<std::string>();
+    *later = std::string(100, 'y');
+    size_t mapped = arena.usage().large_bytes;
+    arena.deallocate_array(buried, 4096);
+    assert(arena.usage().large_bytes == mapped);
+    
+    // STL containers hand superseded buffers back through release_top
+    {
+        std::vector<char, ArenaAllocator<char>> buffer{ArenaAllocator<char>(arena)};
+        buffer.resize(100 * 1024);
+        buffer.resize(300 * 1024);
+        assert(arena.usage().large_bytes < mapped + 400 * 1024);
+    }
+
+    // A large array shrunk below the threshold still lives in its mapping
+    {
+        MemoryArena resized(4096, options);
+        int* kept = resized.allocate_array<int>(100);
+        char* grown = resized.allocate_array<char>(big);
+        size_t block_left = resized.remaining();
+        char* shrunk = resized.reallocate_array(grown, big, 300);
+        assert(shrunk == grown);
+        resized.deallocate_array(shrunk, 300);
+        assert(resized.remaining() == block_left && resized.usage().large_bytes == 0);
+        int* next = resized.allocate_array<int>(100);
+        assert(next && (next >= kept + 100 || next + 100 <= kept));
+
+        // Growing past the mapping moves the array and unmaps the old one
+        grown = resized.allocate_array<char>(big);
+        std::memset(grown, 0x11, big);
+        char* moved = resized.reallocate_array(grown, big, 4 * big);
+        assert(moved && moved != grown && moved[big - 1] == 0x11 && moved[4 * big - 1] == 0);
+        assert(resized.usage().large_bytes >= 4 * big && resized.usage().large_bytes < 5 * big);
+        std::string* names = resized.allocate_array<std::string>(4096);
+        names[4095] = std::string(100, 'z');
+        std::string* renamed = resized.reallocate_array(names, 4096, 8192);
+        assert(renamed && renamed[4095] == std::string(100, 'z'));
+        resized.deallocate_array(renamed, 8192);
+    }
+
+    // An allocate_many group shares one mapping; freeing a member keeps it
+    {
+        MemoryArena grouped(4096, options);
+        auto [first, second] = grouped.allocate_many<char, char>(40000, 40000);
+        assert(first && second && grouped.usage().large_bytes >= 80000);
+        grouped.deallocate_array(first, 40000);
+        std::memset(second, 0x3C, 40000);
+        assert(second[39999] == 0x3C && grouped.usage().large_bytes >= 80000);
+        grouped.reset();
+        assert(grouped.usage().large_bytes == 0);
+    }
+    
+    // Scopes unmap the large buffers made inside them, older ones stay
+    {
+        MemoryArena scoped(4096, options);
+        char* kept = scoped.allocate_array<char>(big);
+        size_t outside = scoped.usage().large_bytes;
+        for (int i = 0; i < 3; ++i) {
+            ArenaScope<> scope(scoped);
+            std::string* buffer = scoped.allocate_array<std::string>(big / sizeof(std::string));
+            assert(buffer && scoped.usage().large_bytes > outside);
+        }
+        assert(scoped.usage().large_bytes == outside);
+        std::memset(kept, 0x42, big);
+    }
+    
+    // reset() and the destructor unmap whatever is left
+    arena.allocate_array<char>(big);
+    arena.reset();
+    assert(arena.usage().large_bytes == 0);
+    assert(arena.remaining() == before);
+    arena.allocate_array<double>(big);
+    
+    // Large mappings count against max_capacity
+    ArenaOptions capped = options;
+    capped.max_capacity = 128 * 1024;
+    MemoryArena limited(4096, capped);
+    assert(limited.allocate_array<char>(100 * 1024) != nullptr);
+    assert(limited.allocate_array<char>(100 * 1024) == nullptr);
+    
+    // ... and so do chained blocks grown next to them
+    ArenaOptions growing = capped;
+    growing.growth = GrowthPolicy::Linear;
+    growing.block_size = 16 * 1024;
+    MemoryArena chained(4096, growing);
+    assert(chained.allocate_array<char>(100 * 1024) != nullptr);
+    while (chained.allocate_array<char>(8 * 1024)) {
+    }
+    ArenaUsage held = chained.usage();
+    assert(held.total_capacity + held.large_bytes <= capped.max_capacity);
+    
+    std::cout << "✓ Large allocations bypass the bump blocks" << std::endl;
+}
+
+struct ParallelCounted {
+    static std::atomic<int> alive;
+    static std::atomic<int> throw_at;
+    int value;
+    
+    ParallelCounted() : value(7) {
+        if (alive.fetch_add(1) + 1 == throw_at.load()) {
+            alive.fetch_sub(1);
+            throw std::runtime_error("construction failed");
+        }
+    }
+    ~ParallelCounted() { alive.fetch_sub(1); }
+};
+
+std::atomic<int> ParallelCounted::alive{0};
+std::atomic<int> ParallelCounted::throw_at{-1};
+
+void test_parallel_array_construction() {
+    std::cout << "\nTesting parallel array construction and destruction..." << std::endl;
+    
+    MemoryArena arena(4 * 1024 * 1024);
+    ArenaThreadScheduler scheduler(4);
+    const size_t count = 100000;
+    
+    ParallelCounted* items = arena.allocate_array<ParallelCounted>(count, scheduler);
+    assert(items && ParallelCounted::alive.load() == static_cast<int>(count));
+    for (size_t i = 0; i < count; ++i) {
+        assert(items[i].value == 7);
+    }
+    arena.deallocate_array(items, count, scheduler);
+    assert(ParallelCounted::alive.load() == 0);
+    
+    // The lock is not held while tasks run, so they may allocate themselves
+    size_t tasks = 0;
+    auto allocating = [&](size_t task_count, const auto& task) {
+        for (size_t i = 0; i < task_count; ++i) {
+            assert(arena.allocate<int>() != nullptr);
+            task(i);
+            ++tasks;
+        }
+    };
+    std::string* strings = arena.allocate_array<std::string>(count, allocating);
+    assert(strings && tasks > 1 && strings[count - 1].empty());
+    strings[0] = std::string(64, 'a');
+    tasks = 0;
+    arena.deallocate_array(strings, count, allocating);
+    assert(tasks > 1);
+    
+    // Small arrays run inline; trivial types are value-initialized
+    double* values = arena.allocate_array<double>(10, scheduler);
+    assert(values && values[9] == 0.0);
+    uint32_t* wide = arena.allocate_array<uint32_t>(count, scheduler);
+    for (size_t i = 0; i < count; ++i) {
+        assert(wide[i] == 0);
+    }
+    
+    // A throwing constructor unwinds every element built so far
+    ParallelCounted::throw_at.store(static_cast<int>(count / 2));
+    bool caught = false;
+    try {
+        arena.allocate_array<ParallelCounted>(count, scheduler);
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    ParallelCounted::throw_at.store(-1);
+    assert(caught && ParallelCounted::alive.load() == 0);
+    
+    // Registered like any other array, so reset() still finalizes it
+    arena.allocate_array<ParallelCounted>(count, scheduler);
+    arena.reset();
+    assert(ParallelCounted::alive.load() == 0);
+    
+    std::cout << "✓ Parallel construction and destruction work correctly" << std::endl;
+}
+
+// Yields in its destructor so that a second reset() gets to run mid-way.
+struct YieldingCounted {
+    static std::atomic<int> destroyed;
+    ~YieldingCounted() {
+        destroyed.fetch_add(1);
+        std::this_thread::yield();
+    }
+};
+
+std::atomic<int> YieldingCounted::destroyed{0};
+
+void test_concurrent_reset_finalizers() {
+    std::cout << "\nTesting concurrent reset finalizers..." << std::endl;
+    
+    MemoryArena arena(1 << 20);
+    for (int round = 0; round < 50; ++round) {
+        YieldingCounted::destroyed.store(0);
+        for (int i = 0; i < 200; ++i) {
+            assert(arena.allocate<YieldingCounted>());
+        }
+        
+        // Both resets race; every destructor must still run exactly once
+        std::atomic<int> ready{0};
+        auto resetter = [&]() {
+            ready.fetch_add(1);
+            while (ready.load() < 2) {
+                std::this_thread::yield();
+            }
+            arena.reset();
+        };
+        std::thread first(resetter);
+        std::thread second(resetter);
+        first.join();
+        second.join();
+        assert(YieldingCounted::destroyed.load() == 200);
+    }
+    
+    std::cout << "✓ Concurrent resets run each finalizer once" << std::endl;
+}
+
+void test_trace_binary_roundtrip() {
+    std::cout << "\nTesting binary trace export and import..." << std::endl;
+    
+    MemoryArena first(4096);
+    MemoryArena second(256);
+    ArenaTraceRecorder recorder(1024);
+    recorder.attach(first);
+    recorder.attach(second);
+    first.allocate<int>();
+    second.allocate_bytes(100, 64);
+    std::thread worker([&]() {
+        first.allocate_array<double>(3);
+    });
+    worker.join();
+    assert(second.allocate_bytes(1000) == nullptr);
+    first.reset();
+    first.allocate_bytes(1 << 10, 1);
+    
+    std::stringstream file;
+    assert(recorder.write_binary(file));
+    std::string bytes = file.str();
+    assert(bytes.size() < recorder.size() * 16);
+    
+    std::vector<ArenaTraceRecorder::Record> records;
+    assert(ArenaTraceRecorder::read_binary(file, records));
+    std::vector<ArenaTraceRecorder::Event> events = recorder.snapshot();
+    assert(records.size() == 6 && events.size() == 6);
+    for (size_t i = 0; i < records.size(); ++i) {
+        assert(records[i].kind == events[i].kind);
+        assert(records[i].timestamp_ns == events[i].timestamp_ns);
+        assert(records[i].thread == events[i].thread);
+        assert(records[i].size == events[i].size);
+        assert(records[i].arena == (events[i].arena == &first ? 0u : 1u));
+        if (events[i].kind != ArenaEvent::Reset) {
+            assert(records[i].alignment == events[i].alignment);
+        }
+    }
+    assert(records[1].alignment == 64 && records[3].kind == ArenaEvent::Failure);
+    assert(records[2].thread != records[0].thread);
+    
+    // Truncated or foreign input is rejected
+    std::stringstream truncated(bytes.substr(0, bytes.size() - 2));
+    assert(!ArenaTraceRecorder::read_binary(truncated, records) && records.empty());
+    std::stringstream foreign("not a trace at all");
+    assert(!ArenaTraceRecorder::read_binary(foreign, records));
+    std::stringstream empty;
+    assert(ArenaTraceRecorder::write_records(empty, {}));
+    assert(ArenaTraceRecorder::read_binary(empty, records) && records.empty());
+    
+    recorder.detach(first);
+    recorder.detach(second);
+    std::cout << "✓ Binary traces round-trip" << std::endl;
+}
+
 int main() {
     std::cout << "=== Memory Arena Advanced Test Suite ===" << std::endl;
     std::cout << "Testing alignment, crash scenarios, and thread safety\n" << std::endl;
@@ -482,19 +2807,50 @@ int main() {
     try {
         test_alignment_correctness();
         test_alignment_padding();
+        test_mark_and_rewind();
         test_potential_crashes_buffer_overrun();
         test_deallocate_crash_scenarios();
+        test_growable_arena();
+        test_mmap_backed_arena();
         test_thread_safety_concurrent_allocation();
+        test_lock_free_allocation();
+        test_thread_safety_contention_benchmark();
+        test_thread_local_arena();
+        test_numa_arena_set();
         test_thread_safety_alloc_dealloc_race();
+        test_epoch_protected_reset();
         test_memory_corruption_detection();
         test_stress_rapid_operations();
         test_constructor_calls();
         test_destructor_calls();
+        test_reset_runs_destructors();
         test_array_allocation();
+        test_array_uninit_and_zeroed();
+        test_allocate_bytes_and_extend();
+        test_reallocate_array();
         test_array_constructors();
         test_array_bounds_checking();
         test_array_deallocation();
         test_mixed_allocation();
+        test_stl_allocator();
+        test_typed_pool();
+        test_arena_heap();
+        test_arena_stats();
+        test_allocation_tracing();
+        test_generational_arena();
+        test_arena_policies();
+        test_static_arena();
+        test_allocate_many();
+        test_arena_soa();
+        test_arena_flat_map();
+        test_arena_snapshot();
+        test_shared_arena();
+        test_coroutine_frames();
+        test_cache_line_isolation();
+        test_large_allocation_bypass();
+        test_parallel_array_construction();
+        test_concurrent_reset_finalizers();
+        test_trace_binary_roundtrip();
         
         std::cout << "\n🎉 All advanced tests completed!" << std::endl;
         std::cout << "Note: Some tests intentionally push boundaries and may expose edge cases." << std::endl;